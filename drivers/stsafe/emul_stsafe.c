@@ -0,0 +1,573 @@
+/*
+ * Copyright (c) 2026, CATIE
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * I2C emulator for the STSAFE-A1xx family.
+ *
+ * Speaks the STSELib frame format:
+ *
+ *   command:  [header][payload...][CRC16 MSB][CRC16 LSB]
+ *   response: [status][length MSB][length LSB][data...][CRC16 MSB][CRC16 LSB]
+ *
+ * where the response length counts the data and the CRC, and both CRCs are
+ * CRC-16/X-25 over header/status and payload/data. Every response can be read
+ * again from its first byte until the next command is written, which is how
+ * STSELib first fetches the length and then the whole frame.
+ *
+ * With CONFIG_EMUL_STSAFE_REPLAY, commands are answered from a capture of
+ * real traffic instead (see drivers/stsafe_capture.h): each command gets the
+ * response the chip gave to the same command in the capture, after the time
+ * the chip took. Commands the capture has nothing for fall back to the model.
+ */
+
+#include <zephyr/device.h>
+#include <zephyr/drivers/emul.h>
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/drivers/i2c_emul.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/crc.h>
+
+#include <drivers/emul_stsafe.h>
+#include <drivers/stsafe_capture.h>
+
+LOG_MODULE_DECLARE(stsafe, CONFIG_STSAFE_LOG_LEVEL);
+
+#define STSAFE_EMUL_FRAME_SIZE     752U
+#define STSAFE_EMUL_RSP_HDR_SIZE   3U
+#define STSAFE_EMUL_CRC_SIZE       2U
+#define STSAFE_EMUL_CMD_MASK       0x1F
+#define STSAFE_EMUL_QUERY_SLOTS    8
+#define STSAFE_EMUL_QUERY_MAX_SIZE 64
+
+struct stsafe_emul_cfg {
+	uint16_t addr;
+	uint8_t bus_id;
+	uint16_t max_frame;
+	uint32_t bus_freq;
+};
+
+struct stsafe_emul_query {
+	uint8_t tag;
+	uint8_t len;
+	bool used;
+	uint8_t data[STSAFE_EMUL_QUERY_MAX_SIZE];
+};
+
+struct stsafe_emul_data {
+	struct k_spinlock lock;
+
+	uint8_t cmd[STSAFE_EMUL_FRAME_SIZE];
+	size_t cmd_len;
+	uint8_t rsp[STSAFE_EMUL_FRAME_SIZE];
+	size_t rsp_len;
+	uint32_t ready_at;
+
+	uint32_t exec_us[EMUL_STSAFE_CMD_COUNT];
+	uint8_t zones[CONFIG_EMUL_STSAFE_ZONE_COUNT][CONFIG_EMUL_STSAFE_ZONE_SIZE];
+	struct stsafe_emul_query queries[STSAFE_EMUL_QUERY_SLOTS];
+	uint32_t prng;
+	bool hibernating;
+
+	uint32_t cmd_count;
+	uint32_t nack_count;
+#ifdef CONFIG_EMUL_STSAFE_REPLAY
+	size_t replay_pos;
+	uint32_t replay_mismatches;
+	bool replay_armed;
+#endif
+};
+
+/* Rough datasheet figures, in microseconds. */
+static const struct {
+	uint8_t cmd;
+	uint32_t exec_us;
+} stsafe_emul_default_timings[] = {
+	{EMUL_STSAFE_CMD_ECHO, 1000},  {EMUL_STSAFE_CMD_GENERATE_RANDOM, 2000},
+	{EMUL_STSAFE_CMD_READ, 3000},  {EMUL_STSAFE_CMD_UPDATE, 8000},
+	{EMUL_STSAFE_CMD_QUERY, 1500},
+};
+
+#define STSAFE_EMUL_DEFAULT_EXEC_US 10000U
+/* Boot time after a wake-up from hibernate */
+#define STSAFE_EMUL_WAKE_US         2000U
+
+static uint16_t stsafe_emul_crc(uint8_t first, const uint8_t *buf, size_t len)
+{
+	uint16_t crc = crc16_ccitt(0xFFFF, &first, 1);
+
+	return crc16_ccitt(crc, buf, len) ^ 0xFFFF;
+}
+
+static bool stsafe_emul_busy(const struct stsafe_emul_data *data)
+{
+	return (int32_t)(k_cycle_get_32() - data->ready_at) < 0;
+}
+
+static uint8_t stsafe_emul_random(struct stsafe_emul_data *data, const uint8_t *payload,
+				  size_t plen, uint8_t *out, size_t *out_len)
+{
+	if (plen != 2) {
+		return EMUL_STSAFE_RSP_INCONSISTENT_DATA;
+	}
+
+	for (size_t i = 0; i < payload[1]; i++) {
+		/* xorshift32: deterministic, good enough to fill a buffer */
+		data->prng ^= data->prng << 13;
+		data->prng ^= data->prng >> 17;
+		data->prng ^= data->prng << 5;
+		out[i] = (uint8_t)data->prng;
+	}
+	*out_len = payload[1];
+	return EMUL_STSAFE_RSP_OK;
+}
+
+static uint8_t stsafe_emul_read(struct stsafe_emul_data *data, const uint8_t *payload, size_t plen,
+				uint8_t *out, size_t *out_len, size_t out_max)
+{
+	if (plen != 6 || payload[1] >= CONFIG_EMUL_STSAFE_ZONE_COUNT) {
+		return EMUL_STSAFE_RSP_INCONSISTENT_DATA;
+	}
+
+	uint16_t offset = sys_get_be16(&payload[2]);
+	uint16_t length = sys_get_be16(&payload[4]);
+
+	if ((size_t)offset + length > CONFIG_EMUL_STSAFE_ZONE_SIZE || length > out_max) {
+		return EMUL_STSAFE_RSP_INCONSISTENT_DATA;
+	}
+
+	memcpy(out, &data->zones[payload[1]][offset], length);
+	*out_len = length;
+	return EMUL_STSAFE_RSP_OK;
+}
+
+static uint8_t stsafe_emul_update(struct stsafe_emul_data *data, const uint8_t *payload,
+				  size_t plen)
+{
+	if (plen < 4 || payload[1] >= CONFIG_EMUL_STSAFE_ZONE_COUNT) {
+		return EMUL_STSAFE_RSP_INCONSISTENT_DATA;
+	}
+
+	uint16_t offset = sys_get_be16(&payload[2]);
+	size_t length = plen - 4;
+
+	if (offset + length > CONFIG_EMUL_STSAFE_ZONE_SIZE) {
+		return EMUL_STSAFE_RSP_INCONSISTENT_DATA;
+	}
+
+	memcpy(&data->zones[payload[1]][offset], &payload[4], length);
+	return EMUL_STSAFE_RSP_OK;
+}
+
+static uint8_t stsafe_emul_query(struct stsafe_emul_data *data, const uint8_t *payload,
+				 size_t plen, uint8_t *out, size_t *out_len)
+{
+	if (plen != 1) {
+		return EMUL_STSAFE_RSP_INCONSISTENT_DATA;
+	}
+
+	for (int i = 0; i < STSAFE_EMUL_QUERY_SLOTS; i++) {
+		if (data->queries[i].used && data->queries[i].tag == payload[0]) {
+			memcpy(out, data->queries[i].data, data->queries[i].len);
+			*out_len = data->queries[i].len;
+			return EMUL_STSAFE_RSP_OK;
+		}
+	}
+
+	memset(out, 0, CONFIG_EMUL_STSAFE_QUERY_DEFAULT_LEN);
+	*out_len = CONFIG_EMUL_STSAFE_QUERY_DEFAULT_LEN;
+	return EMUL_STSAFE_RSP_OK;
+}
+
+static uint8_t stsafe_emul_dispatch(const struct emul *target, uint8_t *cmd, uint8_t *out,
+				    size_t *out_len, size_t out_max)
+{
+	const struct stsafe_emul_cfg *cfg = target->cfg;
+	struct stsafe_emul_data *data = target->data;
+	const uint8_t *payload = &data->cmd[1];
+	size_t plen = data->cmd_len - 1 - STSAFE_EMUL_CRC_SIZE;
+
+	*cmd = data->cmd[0] & STSAFE_EMUL_CMD_MASK;
+
+	switch (*cmd) {
+	case EMUL_STSAFE_CMD_ECHO:
+		if (plen > out_max) {
+			return EMUL_STSAFE_RSP_INCONSISTENT_DATA;
+		}
+		memcpy(out, payload, plen);
+		*out_len = plen;
+		return EMUL_STSAFE_RSP_OK;
+	case EMUL_STSAFE_CMD_GENERATE_RANDOM:
+		return stsafe_emul_random(data, payload, plen, out, out_len);
+	case EMUL_STSAFE_CMD_READ:
+		return stsafe_emul_read(data, payload, plen, out, out_len, out_max);
+	case EMUL_STSAFE_CMD_UPDATE:
+		return stsafe_emul_update(data, payload, plen);
+	case EMUL_STSAFE_CMD_QUERY:
+		return stsafe_emul_query(data, payload, plen, out, out_len);
+	case EMUL_STSAFE_CMD_HIBERNATE:
+		if (plen != 1) {
+			return EMUL_STSAFE_RSP_INCONSISTENT_DATA;
+		}
+		/* Goes to sleep once the response has been read */
+		data->hibernating = true;
+		*out_len = 0;
+		return EMUL_STSAFE_RSP_OK;
+	default:
+		LOG_WRN("emul 0x%02x: unsupported command 0x%02x", cfg->addr, data->cmd[0]);
+		return EMUL_STSAFE_RSP_INCONSISTENT_DATA;
+	}
+}
+
+#ifdef CONFIG_EMUL_STSAFE_REPLAY
+static const uint8_t stsafe_emul_capture[] = {
+#include "stsafe_replay.inc"
+};
+
+struct stsafe_emul_rec {
+	uint64_t time_us;
+	uint8_t bus_id;
+	uint8_t dir;
+	uint16_t len;
+	const uint8_t *frame;
+};
+
+/* Record at @p pos, false past the end of the capture */
+static bool stsafe_emul_rec_get(size_t pos, struct stsafe_emul_rec *rec)
+{
+	if (pos + STSAFE_CAPTURE_REC_SIZE > sizeof(stsafe_emul_capture)) {
+		return false;
+	}
+
+	const uint8_t *p = &stsafe_emul_capture[pos];
+
+	rec->time_us = sys_get_le64(&p[0]);
+	rec->bus_id = p[8];
+	rec->dir = p[9];
+	rec->len = sys_get_le16(&p[10]);
+	rec->frame = &p[STSAFE_CAPTURE_REC_SIZE];
+	return pos + STSAFE_CAPTURE_REC_SIZE + rec->len <= sizeof(stsafe_emul_capture);
+}
+
+static size_t stsafe_emul_rec_next(size_t pos, const struct stsafe_emul_rec *rec)
+{
+	return pos + STSAFE_CAPTURE_REC_SIZE + rec->len;
+}
+
+/*
+ * Answer the command with the next exchange of this instance in the capture:
+ * the longest response read after it, once the chip time has elapsed. A
+ * command with another header than the captured one is left to the model
+ * without moving on, so that extra commands do not throw the replay off.
+ *
+ * The chip time is taken from the last read the chip NACKed, when there is
+ * one: the first response only says when the recording driver polled again,
+ * which would replay its polling schedule rather than the chip.
+ */
+static bool stsafe_emul_replay(const struct emul *target)
+{
+	const struct stsafe_emul_cfg *cfg = target->cfg;
+	struct stsafe_emul_data *data = target->data;
+	struct stsafe_emul_rec cmd;
+	struct stsafe_emul_rec rec;
+	size_t pos = data->replay_pos;
+	bool found = false;
+
+	while (stsafe_emul_rec_get(pos, &cmd)) {
+		pos = stsafe_emul_rec_next(pos, &cmd);
+		if (cmd.bus_id == cfg->bus_id && cmd.dir == STSAFE_CAPTURE_CMD && cmd.len != 0) {
+			found = true;
+			break;
+		}
+	}
+	if (!found) {
+		/* Past the end of the capture */
+		data->replay_mismatches++;
+		return false;
+	}
+	if (cmd.frame[0] != data->cmd[0]) {
+		data->replay_mismatches++;
+		LOG_WRN("emul 0x%02x: command 0x%02x not next in the capture", cfg->addr,
+			data->cmd[0]);
+		return false;
+	}
+	if (cmd.len != data->cmd_len || memcmp(cmd.frame, data->cmd, cmd.len) != 0) {
+		/* Same command, other arguments: the recorded response still stands in */
+		data->replay_mismatches++;
+	}
+
+	uint64_t done_us = cmd.time_us;
+	uint64_t nack_us = 0;
+
+	data->rsp_len = 0;
+	for (; stsafe_emul_rec_get(pos, &rec); pos = stsafe_emul_rec_next(pos, &rec)) {
+		if (rec.bus_id != cfg->bus_id) {
+			continue;
+		}
+		if (rec.dir == STSAFE_CAPTURE_CMD) {
+			break;
+		}
+		if (rec.dir == STSAFE_CAPTURE_NACK) {
+			nack_us = rec.time_us;
+			continue;
+		}
+		if (data->rsp_len == 0) {
+			done_us = rec.time_us;
+		}
+		if (rec.len > data->rsp_len && rec.len <= sizeof(data->rsp)) {
+			memcpy(data->rsp, rec.frame, rec.len);
+			data->rsp_len = rec.len;
+		}
+	}
+	data->replay_pos = pos;
+
+	if ((data->cmd[0] & STSAFE_EMUL_CMD_MASK) == EMUL_STSAFE_CMD_HIBERNATE) {
+		data->hibernating = true;
+	}
+	if (nack_us > cmd.time_us && nack_us < done_us) {
+		done_us = nack_us;
+	}
+	data->ready_at = k_cycle_get_32() + k_us_to_cyc_ceil32(done_us - cmd.time_us);
+	return data->rsp_len != 0;
+}
+#endif /* CONFIG_EMUL_STSAFE_REPLAY */
+
+static void stsafe_emul_process(const struct emul *target)
+{
+	const struct stsafe_emul_cfg *cfg = target->cfg;
+	struct stsafe_emul_data *data = target->data;
+	uint8_t *out = &data->rsp[STSAFE_EMUL_RSP_HDR_SIZE];
+	size_t out_max = cfg->max_frame - STSAFE_EMUL_RSP_HDR_SIZE - STSAFE_EMUL_CRC_SIZE;
+	size_t out_len = 0;
+	uint8_t status;
+	uint8_t cmd = EMUL_STSAFE_CMD_ECHO;
+
+	data->cmd_count++;
+
+#ifdef CONFIG_EMUL_STSAFE_REPLAY
+	if (data->replay_armed && stsafe_emul_replay(target)) {
+		return;
+	}
+#endif
+
+	if (data->cmd_len < 1 + STSAFE_EMUL_CRC_SIZE ||
+	    stsafe_emul_crc(data->cmd[0], &data->cmd[1], data->cmd_len - 3) !=
+		    sys_get_be16(&data->cmd[data->cmd_len - STSAFE_EMUL_CRC_SIZE])) {
+		LOG_WRN("emul 0x%02x: bad command frame (%zu bytes)", cfg->addr, data->cmd_len);
+		status = EMUL_STSAFE_RSP_COMM_ERROR;
+	} else {
+		status = stsafe_emul_dispatch(target, &cmd, out, &out_len, out_max);
+	}
+
+	data->rsp[0] = status;
+	sys_put_be16(out_len + STSAFE_EMUL_CRC_SIZE, &data->rsp[1]);
+	sys_put_be16(stsafe_emul_crc(status, out, out_len), &out[out_len]);
+	data->rsp_len = STSAFE_EMUL_RSP_HDR_SIZE + out_len + STSAFE_EMUL_CRC_SIZE;
+	data->ready_at = k_cycle_get_32() + k_us_to_cyc_ceil32(data->exec_us[cmd]);
+}
+
+static int stsafe_emul_transfer(const struct emul *target, struct i2c_msg *msgs, int num_msgs,
+				int addr)
+{
+	const struct stsafe_emul_cfg *cfg = target->cfg;
+	struct stsafe_emul_data *data = target->data;
+	size_t wire_bytes = 1;
+	size_t rd_offset = 0;
+	int ret = 0;
+
+	ARG_UNUSED(addr);
+
+	K_SPINLOCK(&data->lock) {
+		if (stsafe_emul_busy(data)) {
+			/* The chip does not acknowledge its address while computing */
+			data->nack_count++;
+			ret = -EIO;
+			K_SPINLOCK_BREAK;
+		}
+		if (data->hibernating && (msgs[0].flags & I2C_MSG_READ) == I2C_MSG_WRITE) {
+			/* Woken up by its address, then boots without answering */
+			data->hibernating = false;
+			data->ready_at = k_cycle_get_32() + k_us_to_cyc_ceil32(STSAFE_EMUL_WAKE_US);
+			data->nack_count++;
+			ret = -EIO;
+			K_SPINLOCK_BREAK;
+		}
+
+		data->cmd_len = 0;
+		for (int i = 0; i < num_msgs; i++) {
+			struct i2c_msg *msg = &msgs[i];
+
+			wire_bytes += msg->len;
+
+			if ((msg->flags & I2C_MSG_READ) == I2C_MSG_WRITE) {
+				if (data->cmd_len + msg->len > sizeof(data->cmd)) {
+					ret = -EIO;
+					break;
+				}
+				memcpy(&data->cmd[data->cmd_len], msg->buf, msg->len);
+				data->cmd_len += msg->len;
+				continue;
+			}
+
+			if (data->rsp_len == 0) {
+				ret = -EIO;
+				break;
+			}
+			for (uint32_t j = 0; j < msg->len; j++, rd_offset++) {
+				/* Reading past the frame returns padding, like the chip */
+				msg->buf[j] = rd_offset < data->rsp_len ? data->rsp[rd_offset]
+									 : 0xFF;
+			}
+		}
+
+		if (ret == 0 && data->cmd_len > 0) {
+			stsafe_emul_process(target);
+		}
+	}
+
+	/* Wire time of the transfer: 9 bits per byte, address byte included */
+	k_busy_wait((uint32_t)(wire_bytes * 9U * USEC_PER_SEC / cfg->bus_freq));
+
+	return ret;
+}
+
+void emul_stsafe_set_exec_time(const struct emul *target, uint8_t cmd, uint32_t exec_us)
+{
+	struct stsafe_emul_data *data = target->data;
+
+	if (cmd < EMUL_STSAFE_CMD_COUNT) {
+		data->exec_us[cmd] = exec_us;
+	}
+}
+
+uint8_t *emul_stsafe_get_zone(const struct emul *target, uint8_t zone, size_t *size)
+{
+	struct stsafe_emul_data *data = target->data;
+
+	if (zone >= CONFIG_EMUL_STSAFE_ZONE_COUNT) {
+		return NULL;
+	}
+	*size = CONFIG_EMUL_STSAFE_ZONE_SIZE;
+	return data->zones[zone];
+}
+
+int emul_stsafe_set_query_response(const struct emul *target, uint8_t tag, const uint8_t *buf,
+				   size_t len)
+{
+	struct stsafe_emul_data *data = target->data;
+	struct stsafe_emul_query *slot = NULL;
+
+	if (len > STSAFE_EMUL_QUERY_MAX_SIZE) {
+		return -ENOMEM;
+	}
+
+	for (int i = 0; i < STSAFE_EMUL_QUERY_SLOTS; i++) {
+		if (data->queries[i].used && data->queries[i].tag == tag) {
+			slot = &data->queries[i];
+			break;
+		}
+		if (!data->queries[i].used && slot == NULL) {
+			slot = &data->queries[i];
+		}
+	}
+	if (slot == NULL) {
+		return -ENOMEM;
+	}
+
+	slot->tag = tag;
+	slot->len = len;
+	slot->used = true;
+	memcpy(slot->data, buf, len);
+	return 0;
+}
+
+uint32_t emul_stsafe_get_cmd_count(const struct emul *target)
+{
+	const struct stsafe_emul_data *data = target->data;
+
+	return data->cmd_count;
+}
+
+uint32_t emul_stsafe_get_nack_count(const struct emul *target)
+{
+	const struct stsafe_emul_data *data = target->data;
+
+	return data->nack_count;
+}
+
+#ifdef CONFIG_EMUL_STSAFE_REPLAY
+uint32_t emul_stsafe_get_replay_mismatches(const struct emul *target)
+{
+	const struct stsafe_emul_data *data = target->data;
+
+	return data->replay_mismatches;
+}
+
+void emul_stsafe_replay_arm(const struct emul *target)
+{
+	struct stsafe_emul_data *data = target->data;
+
+	data->replay_pos = STSAFE_CAPTURE_HDR_SIZE;
+	data->replay_mismatches = 0;
+	data->replay_armed = sizeof(stsafe_emul_capture) >= STSAFE_CAPTURE_HDR_SIZE &&
+			     sys_get_le32(stsafe_emul_capture) == STSAFE_CAPTURE_MAGIC &&
+			     sys_get_le16(&stsafe_emul_capture[4]) == STSAFE_CAPTURE_VERSION;
+}
+#endif
+
+static int stsafe_emul_init(const struct emul *target, const struct device *parent)
+{
+	const struct stsafe_emul_cfg *cfg = target->cfg;
+	struct stsafe_emul_data *data = target->data;
+
+	ARG_UNUSED(parent);
+
+	for (int i = 0; i < EMUL_STSAFE_CMD_COUNT; i++) {
+		data->exec_us[i] = STSAFE_EMUL_DEFAULT_EXEC_US;
+	}
+	for (int i = 0; i < ARRAY_SIZE(stsafe_emul_default_timings); i++) {
+		data->exec_us[stsafe_emul_default_timings[i].cmd] =
+			stsafe_emul_default_timings[i].exec_us;
+	}
+
+	data->prng = 0x5AFE0000U | cfg->addr;
+	data->ready_at = k_cycle_get_32();
+#ifdef CONFIG_EMUL_STSAFE_REPLAY
+	if (sizeof(stsafe_emul_capture) < STSAFE_CAPTURE_HDR_SIZE ||
+	    sys_get_le32(stsafe_emul_capture) != STSAFE_CAPTURE_MAGIC ||
+	    sys_get_le16(&stsafe_emul_capture[4]) != STSAFE_CAPTURE_VERSION) {
+		LOG_ERR("emul 0x%02x: replay file is not a version %u capture", cfg->addr,
+			STSAFE_CAPTURE_VERSION);
+	}
+#endif
+	return 0;
+}
+
+static const struct i2c_emul_api stsafe_emul_bus_api = {
+	.transfer = stsafe_emul_transfer,
+};
+
+#define STSAFE_EMUL(inst, variant, frame, bus_base)                                                \
+	static struct stsafe_emul_data stsafe_emul_data_##variant##_##inst;                        \
+	static const struct stsafe_emul_cfg stsafe_emul_cfg_##variant##_##inst = {                 \
+		.addr = DT_INST_REG_ADDR(inst),                                                    \
+		.bus_id = (bus_base) + inst,                                                       \
+		.max_frame = frame,                                                                \
+		.bus_freq = DT_PROP_OR(DT_INST_BUS(inst), clock_frequency, 400000),                \
+	};                                                                                         \
+	EMUL_DT_INST_DEFINE(inst, stsafe_emul_init, &stsafe_emul_data_##variant##_##inst,          \
+			    &stsafe_emul_cfg_##variant##_##inst, &stsafe_emul_bus_api, NULL)
+
+/* Bus IDs numbered like the driver's, which is what the capture records */
+#define STSAFE_EMUL_A120(inst) STSAFE_EMUL(inst, a120, 752U, 0)
+#define STSAFE_EMUL_A110(inst)                                                                     \
+	STSAFE_EMUL(inst, a110, 507U, DT_NUM_INST_STATUS_OKAY(st_stsafe_a120))
+
+#define DT_DRV_COMPAT st_stsafe_a120
+DT_INST_FOREACH_STATUS_OKAY(STSAFE_EMUL_A120)
+#undef DT_DRV_COMPAT
+
+#define DT_DRV_COMPAT st_stsafe_a110
+DT_INST_FOREACH_STATUS_OKAY(STSAFE_EMUL_A110)
+#undef DT_DRV_COMPAT
@@ -9,6 +9,8 @@
 #include <zephyr/logging/log.h>
 LOG_MODULE_DECLARE(stsafe, CONFIG_STSAFE_LOG_LEVEL);
 
+#include "stse_aes.h"
+
 stse_ReturnCode_t stse_platform_aes_ecb_enc(const PLAT_UI8 *pPlaintext, PLAT_UI16 plaintext_length,
 					    const PLAT_UI32 key_idx, PLAT_UI8 *pEncryptedtext,
 					    PLAT_UI16 *pEncryptedtext_length)
@@ -22,11 +24,32 @@ stse_ReturnCode_t stse_platform_aes_ecb_enc(const PLAT_UI8 *pPlaintext, PLAT_UI1
 		return STSE_CORE_INVALID_PARAMETER;
 	}
 
-	uint8_t iv[16] = {0};
+	psa_key_id_t ecb_key = stse_aes_ecb_key(key_idx);
+
+	if (ecb_key == PSA_KEY_ID_NULL) {
+		/* Not the session cipher key: a zero IV CBC block is the same ECB block */
+		uint8_t iv[16] = {0};
+
+		LOG_DBG("No ECB key for index %u, using CBC", key_idx);
+		return stse_platform_aes_cbc_enc(pPlaintext, plaintext_length, iv, key_idx,
+						 pEncryptedtext, pEncryptedtext_length);
+	}
+
+	/* Single block: one call, no multi-part operation to set up and tear down */
+	size_t out_len = 0;
+	psa_status_t st = psa_cipher_encrypt(ecb_key, PSA_ALG_ECB_NO_PADDING, pPlaintext,
+					     plaintext_length, pEncryptedtext, plaintext_length,
+					     &out_len);
+
+	if (st != PSA_SUCCESS) {
+		LOG_ERR("aes_ecb_enc: AES-ECB encryption failed: %d", st);
+		return STSE_SESSION_ERROR;
+	}
 
-	LOG_DBG("Encrypting 16 bytes with AES-ECB using key index %u", key_idx);
-	return stse_platform_aes_cbc_enc(pPlaintext, plaintext_length, iv, key_idx, pEncryptedtext,
-					 pEncryptedtext_length);
+	if (pEncryptedtext_length) {
+		*pEncryptedtext_length = (PLAT_UI16)out_len;
+	}
+	return STSE_OK;
 }
 
 stse_ReturnCode_t stse_platform_aes_cbc_enc(const PLAT_UI8 *pPlaintext, PLAT_UI16 plaintext_length,
@@ -70,7 +93,7 @@ stse_ReturnCode_t stse_platform_aes_cbc_enc(const PLAT_UI8 *pPlaintext, PLAT_UI1
 	psa_cipher_abort(&op);
 
 	if (st != PSA_SUCCESS) {
-		LOG_ERR("Invalid parameter: plaintext, initial value or encryptedtext is NULL");
+		LOG_ERR("aes_cbc_enc: AES-CBC encryption failed");
 		return STSE_SESSION_ERROR;
 	}
 
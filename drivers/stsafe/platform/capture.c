@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2026, CATIE
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Capture of the I2C traffic, in the format of drivers/stsafe_capture.h.
+ *
+ * Records are appended to a static buffer until it is full. Room for a
+ * record is claimed under a spinlock and the frame copied in afterwards, so
+ * instances on different buses can record at the same time; the buffer is
+ * only read once the capture is stopped.
+ *
+ * Timestamps are 64-bit microseconds, as a 32-bit cycle count wraps in less
+ * than a minute on fast parts. Without a 64-bit cycle counter, the cycles
+ * elapsed since the previous record are added up while the uptime says the
+ * counter cannot have wrapped in between, and the coarser uptime otherwise.
+ */
+
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/byteorder.h>
+
+#include <drivers/stsafe_capture.h>
+
+#include "stse_trace.h"
+
+static uint8_t capture_buf[CONFIG_STSAFE_CAPTURE_SIZE];
+static struct k_spinlock capture_lock;
+static size_t capture_len;
+static bool capture_on;
+static bool capture_truncated;
+#ifdef CONFIG_TIMER_HAS_64BIT_CYCLE_COUNTER
+static uint64_t capture_start_cyc;
+#else
+static uint64_t capture_cyc;
+static uint32_t capture_last_cyc;
+static int64_t capture_last_ticks;
+#endif
+
+/* Time since the start of the capture, caller holds capture_lock */
+static uint64_t capture_now_us(bool start)
+{
+#ifdef CONFIG_TIMER_HAS_64BIT_CYCLE_COUNTER
+	if (start) {
+		capture_start_cyc = k_cycle_get_64();
+	}
+	return k_cyc_to_us_floor64(k_cycle_get_64() - capture_start_cyc);
+#else
+	uint32_t cyc = k_cycle_get_32();
+	int64_t ticks = k_uptime_ticks();
+
+	if (start) {
+		capture_cyc = 0;
+	} else if (k_ticks_to_cyc_floor64(ticks - capture_last_ticks) < UINT32_MAX / 2) {
+		capture_cyc += (uint32_t)(cyc - capture_last_cyc);
+	} else {
+		capture_cyc += k_ticks_to_cyc_floor64(ticks - capture_last_ticks);
+	}
+	capture_last_cyc = cyc;
+	capture_last_ticks = ticks;
+	return k_cyc_to_us_floor64(capture_cyc);
+#endif
+}
+
+uint8_t *stse_capture_claim(uint8_t bus_id, uint8_t dir, uint16_t len)
+{
+	uint64_t us;
+	uint8_t *rec = NULL;
+
+	K_SPINLOCK(&capture_lock) {
+		if (!capture_on) {
+			K_SPINLOCK_BREAK;
+		}
+		if (capture_len + STSAFE_CAPTURE_REC_SIZE + len > sizeof(capture_buf)) {
+			capture_truncated = true;
+			capture_on = false;
+			K_SPINLOCK_BREAK;
+		}
+		us = capture_now_us(false);
+		rec = &capture_buf[capture_len];
+		capture_len += STSAFE_CAPTURE_REC_SIZE + len;
+	}
+	if (rec == NULL) {
+		return NULL;
+	}
+
+	sys_put_le64(us, &rec[0]);
+	rec[8] = bus_id;
+	rec[9] = dir;
+	sys_put_le16(len, &rec[10]);
+	return &rec[STSAFE_CAPTURE_REC_SIZE];
+}
+
+void stsafe_capture_start(void)
+{
+	K_SPINLOCK(&capture_lock) {
+		sys_put_le32(STSAFE_CAPTURE_MAGIC, &capture_buf[0]);
+		sys_put_le16(STSAFE_CAPTURE_VERSION, &capture_buf[4]);
+		sys_put_le16(0, &capture_buf[6]);
+		capture_len = STSAFE_CAPTURE_HDR_SIZE;
+		capture_truncated = false;
+		(void)capture_now_us(true);
+		capture_on = true;
+	}
+}
+
+size_t stsafe_capture_stop(void)
+{
+	size_t len;
+
+	K_SPINLOCK(&capture_lock) {
+		capture_on = false;
+		len = capture_len;
+	}
+	return len;
+}
+
+const uint8_t *stsafe_capture_get(size_t *len, bool *truncated)
+{
+	K_SPINLOCK(&capture_lock) {
+		*len = capture_len;
+		if (truncated != NULL) {
+			*truncated = capture_truncated;
+		}
+	}
+	return capture_buf;
+}
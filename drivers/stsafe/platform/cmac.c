@@ -7,20 +7,82 @@
 LOG_MODULE_DECLARE(stsafe, CONFIG_STSAFE_LOG_LEVEL);
 
 #include "stselib.h"
+#include "../stsafe_priv.h"
+#ifdef CONFIG_STSAFE_STATS
+#include "stse_stats.h"
+#endif
 
 #include <psa/crypto.h>
 typedef struct {
+	k_tid_t owner;
 	psa_key_id_t key_id;
 	psa_mac_operation_t op;
 } stsafea1xx_psa_cmac_ctx_t;
-static stsafea1xx_psa_cmac_ctx_t g_cmaccontext = {0};
+
+/*
+ * One MAC operation per thread running a session, so that sessions of
+ * different threads run side by side whether or not they hold an instance.
+ * A context is taken by the thread at init and given back once the tag is
+ * finished; there is one per instance plus one for simple mode callers.
+ */
+static stsafea1xx_psa_cmac_ctx_t g_cmaccontexts[STSAFE_NUM_INSTANCES + 1];
+static struct k_spinlock g_cmaccontexts_lock;
+
+/* Context of the calling thread, taking a free one if @p claim */
+static stsafea1xx_psa_cmac_ctx_t *cmac_context(bool claim)
+{
+	k_tid_t self = k_current_get();
+	stsafea1xx_psa_cmac_ctx_t *ctx = NULL;
+	stsafea1xx_psa_cmac_ctx_t *free_ctx = NULL;
+
+	K_SPINLOCK(&g_cmaccontexts_lock) {
+		for (size_t i = 0; i < ARRAY_SIZE(g_cmaccontexts); i++) {
+			if (g_cmaccontexts[i].owner == self) {
+				ctx = &g_cmaccontexts[i];
+				break;
+			}
+			if (free_ctx == NULL && g_cmaccontexts[i].owner == NULL) {
+				free_ctx = &g_cmaccontexts[i];
+			}
+		}
+		if (ctx == NULL && claim && free_ctx != NULL) {
+			ctx = free_ctx;
+			ctx->owner = self;
+		}
+	}
+	return ctx;
+}
+
+static void cmac_context_release(stsafea1xx_psa_cmac_ctx_t *ctx)
+{
+	psa_mac_abort(&ctx->op);
+	K_SPINLOCK(&g_cmaccontexts_lock) {
+		ctx->owner = NULL;
+	}
+}
 
 stse_ReturnCode_t stse_platform_aes_cmac_init(const PLAT_UI32 key_idx, PLAT_UI16 exp_tag_size)
 {
-	g_cmaccontext.key_id = (psa_key_id_t)key_idx;
-	g_cmaccontext.op = psa_mac_operation_init();
-	psa_status_t status =
-		psa_mac_sign_setup(&g_cmaccontext.op, g_cmaccontext.key_id, PSA_ALG_CMAC);
+#ifdef CONFIG_STSAFE_STATS
+	uint32_t start = k_cycle_get_32();
+#endif
+	stsafea1xx_psa_cmac_ctx_t *ctx = cmac_context(true);
+
+	if (ctx == NULL) {
+		LOG_ERR("AES-CMAC init: no free context");
+		return STSE_PLATFORM_AES_CMAC_COMPUTE_ERROR;
+	}
+	/* A session the thread left unfinished is dropped */
+	psa_mac_abort(&ctx->op);
+	ctx->key_id = (psa_key_id_t)key_idx;
+	ctx->op = psa_mac_operation_init();
+	psa_status_t status = psa_mac_sign_setup(&ctx->op, ctx->key_id, PSA_ALG_CMAC);
+#ifdef CONFIG_STSAFE_STATS
+	stse_stats_cmac(start, false);
+#endif
+	if (status != PSA_SUCCESS) {
+		cmac_context_release(ctx);
+	}
 
 	LOG_DBG("AES-CMAC init with key %u, expected tag size %u: %s", key_idx, exp_tag_size,
 		(status == PSA_SUCCESS) ? "success" : "failure");
@@ -29,7 +91,15 @@ stse_ReturnCode_t stse_platform_aes_cmac_init(const PLAT_UI32 key_idx, PLAT_UI16
 
 stse_ReturnCode_t stse_platform_aes_cmac_append(PLAT_UI8 *pInput, PLAT_UI16 length)
 {
-	psa_status_t status = psa_mac_update(&g_cmaccontext.op, pInput, length);
+#ifdef CONFIG_STSAFE_STATS
+	uint32_t start = k_cycle_get_32();
+#endif
+	stsafea1xx_psa_cmac_ctx_t *ctx = cmac_context(false);
+	psa_status_t status = (ctx != NULL) ? psa_mac_update(&ctx->op, pInput, length)
+					    : PSA_ERROR_BAD_STATE;
+#ifdef CONFIG_STSAFE_STATS
+	stse_stats_cmac(start, false);
+#endif
 	LOG_DBG("AES-CMAC update with %u bytes: %s", length,
 		(status == PSA_SUCCESS) ? "success" : "failure");
 	return (status == PSA_SUCCESS) ? STSE_OK : STSE_PLATFORM_AES_CMAC_COMPUTE_ERROR;
@@ -39,10 +109,20 @@ stse_ReturnCode_t stse_platform_aes_cmac_compute_finish(PLAT_UI8 *pTag, PLAT_UI8
 {
 	uint8_t full_tag[16];
 	size_t full_len = 0;
+#ifdef CONFIG_STSAFE_STATS
+	uint32_t start = k_cycle_get_32();
+#endif
+
+	stsafea1xx_psa_cmac_ctx_t *ctx = cmac_context(false);
+	psa_status_t st = PSA_ERROR_BAD_STATE;
 
-	psa_status_t st =
-		psa_mac_sign_finish(&g_cmaccontext.op, full_tag, sizeof(full_tag), &full_len);
-	psa_mac_abort(&g_cmaccontext.op);
+	if (ctx != NULL) {
+		st = psa_mac_sign_finish(&ctx->op, full_tag, sizeof(full_tag), &full_len);
+		cmac_context_release(ctx);
+	}
+#ifdef CONFIG_STSAFE_STATS
+	stse_stats_cmac(start, true);
+#endif
 	if (st != PSA_SUCCESS || full_len != 16) {
 		LOG_ERR("AES-CMAC compute finish failed: %s",
 			(st == PSA_SUCCESS) ? "invalid tag length" : "failure");
@@ -60,10 +140,20 @@ stse_ReturnCode_t stse_platform_aes_cmac_verify_finish(PLAT_UI8 *pTag)
 {
 	uint8_t full_tag[16];
 	size_t full_len = 0;
+#ifdef CONFIG_STSAFE_STATS
+	uint32_t start = k_cycle_get_32();
+#endif
 
-	psa_status_t st =
-		psa_mac_sign_finish(&g_cmaccontext.op, full_tag, sizeof(full_tag), &full_len);
-	psa_mac_abort(&g_cmaccontext.op);
+	stsafea1xx_psa_cmac_ctx_t *ctx = cmac_context(false);
+	psa_status_t st = PSA_ERROR_BAD_STATE;
+
+	if (ctx != NULL) {
+		st = psa_mac_sign_finish(&ctx->op, full_tag, sizeof(full_tag), &full_len);
+		cmac_context_release(ctx);
+	}
+#ifdef CONFIG_STSAFE_STATS
+	stse_stats_cmac(start, true);
+#endif
 	if (st != PSA_SUCCESS || full_len != 16) {
 		LOG_ERR("AES-CMAC verify finish failed: %s",
 			(st == PSA_SUCCESS) ? "invalid tag length" : "failure");
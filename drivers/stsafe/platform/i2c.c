@@ -6,52 +6,220 @@
 #include <zephyr/device.h>
 #include <zephyr/drivers/i2c.h>
 #include "drivers/stsafe.h"
+#include "drivers/stsafe_capture.h"
+#include "../stsafe_priv.h"
+#include "stse_i2c.h"
 
 #include <zephyr/logging/log.h>
 LOG_MODULE_DECLARE(stsafe, CONFIG_STSAFE_LOG_LEVEL);
 
 /*
- * The STSELib platform layer needs a per-instance scratch buffer to assemble
- * frames before sending them on the wire (and to receive responses). The buffer
- * size depends on the chip variant:
+ * Every instance registers its context here in stse_platform_i2c_init(), so
+ * that the busID passed back by STSELib routes to the right device.
  *
- *   - STSAFE-A110: up to 507 bytes per frame
- *   - STSAFE-A120: up to 752 bytes per frame
- *
- * The driver supports both variants in the same firmware, so we size every
- * buffer to the maximum. This costs 245 bytes per A110 instance.
+ * With CONFIG_STSAFE_I2C_ZERO_COPY, fragments handed over by STSELib are
+ * recorded as one i2c_msg each and moved in a single i2c_transfer(), straight
+ * from and into the caller's buffers. Only the response length probe, which
+ * is where STSELib polls for the NACK of a busy chip, still goes through the
+ * context buffer.
  */
-#define STSAFE_I2C_BUFFER_SIZE 752U
-
-// Mirror of stsafe_config from stsafe.c
-struct stsafe_config {
-	struct i2c_dt_spec i2c;
-	struct gpio_dt_spec reset_gpio;
-	int bus_id;
-	uint8_t device_type;
-};
+static struct stsafe_i2c_ctx *ctx_table[STSAFE_NUM_INSTANCES];
+
+/*
+ * Chip last addressed by each thread, whether it holds the instance, brings
+ * it up or puts it to sleep. With thread-local storage every thread records
+ * its own; otherwise a small table is shared out by thread, the least
+ * recently used entry going to a new thread.
+ */
+#ifdef CONFIG_THREAD_LOCAL_STORAGE
+static __thread struct stsafe_i2c_ctx *i2c_addressed;
+
+static inline void stsafe_i2c_addressing(struct stsafe_i2c_ctx *ctx)
+{
+	i2c_addressed = ctx;
+}
 
-struct stsafe_i2c_ctx {
-	const struct device *i2c_bus;
-	uint16_t i2c_addr;
-	uint8_t buffer[STSAFE_I2C_BUFFER_SIZE];
-	uint16_t frame_size;
-	uint16_t frame_offset;
-	int bus_id;
-	bool used;
+struct stsafe_i2c_ctx *stse_i2c_addressed(void)
+{
+	return i2c_addressed;
+}
+#else
+struct stsafe_i2c_talker {
+	k_tid_t tid;
+	uint32_t used;
+	struct stsafe_i2c_ctx *ctx;
 };
 
-static struct stsafe_i2c_ctx ctx_table[CONFIG_STSAFE_MAX_INSTANCES];
+static struct stsafe_i2c_talker i2c_talkers[STSAFE_NUM_INSTANCES + 1];
+static struct k_spinlock i2c_talkers_lock;
+static uint32_t i2c_talkers_clock;
+
+static void stsafe_i2c_addressing(struct stsafe_i2c_ctx *ctx)
+{
+	k_tid_t self = k_current_get();
+
+	K_SPINLOCK(&i2c_talkers_lock) {
+		struct stsafe_i2c_talker *t = &i2c_talkers[0];
+
+		for (size_t i = 0; i < ARRAY_SIZE(i2c_talkers); i++) {
+			if (i2c_talkers[i].tid == self) {
+				t = &i2c_talkers[i];
+				break;
+			}
+			if ((int32_t)(i2c_talkers[i].used - t->used) < 0) {
+				t = &i2c_talkers[i];
+			}
+		}
+		t->tid = self;
+		t->ctx = ctx;
+		t->used = ++i2c_talkers_clock;
+	}
+}
+
+struct stsafe_i2c_ctx *stse_i2c_addressed(void)
+{
+	k_tid_t self = k_current_get();
+	struct stsafe_i2c_ctx *ctx = NULL;
+
+	K_SPINLOCK(&i2c_talkers_lock) {
+		for (size_t i = 0; i < ARRAY_SIZE(i2c_talkers); i++) {
+			if (i2c_talkers[i].tid == self) {
+				ctx = i2c_talkers[i].ctx;
+				break;
+			}
+		}
+	}
+	return ctx;
+}
+#endif
+
+#ifdef CONFIG_STSAFE_I2C_ZERO_COPY
+static const uint8_t stsafe_i2c_zeros[STSAFE_I2C_SCRATCH_SIZE];
 
+static stse_ReturnCode_t stsafe_i2c_add_msg(struct stsafe_i2c_ctx *ctx, uint8_t *buf, uint16_t len,
+					    uint8_t flags)
+{
+	if (ctx->num_msgs >= ARRAY_SIZE(ctx->msgs)) {
+		LOG_ERR("frame has more than %d fragments", CONFIG_STSAFE_I2C_MAX_FRAGMENTS);
+		return STSE_PLATFORM_BUFFER_ERR;
+	}
+	if (ctx->frame_offset + len > ctx->frame_size) {
+		LOG_ERR("fragment overflows frame length %u", ctx->frame_size);
+		return STSE_PLATFORM_BUFFER_ERR;
+	}
+
+	ctx->msgs[ctx->num_msgs++] = (struct i2c_msg){
+		.buf = buf,
+		.len = len,
+		.flags = flags,
+	};
+	ctx->frame_offset += len;
+	return STSE_OK;
+}
+
+/* A NULL fragment is zero padding on send and discarded bytes on receive */
+static stse_ReturnCode_t stsafe_i2c_add_fragment(struct stsafe_i2c_ctx *ctx, uint8_t *pData,
+						 uint16_t data_size, uint8_t flags)
+{
+	stse_ReturnCode_t ret = STSE_OK;
+
+	if (pData != NULL) {
+		return data_size != 0 ? stsafe_i2c_add_msg(ctx, pData, data_size, flags) : STSE_OK;
+	}
+
+	uint8_t *filler = (flags & I2C_MSG_READ) ? ctx->buffer : (uint8_t *)stsafe_i2c_zeros;
+
+	while (data_size != 0 && ret == STSE_OK) {
+		uint16_t chunk = MIN(data_size, STSAFE_I2C_SCRATCH_SIZE);
+
+		ret = stsafe_i2c_add_msg(ctx, filler, chunk, flags);
+		data_size -= chunk;
+	}
+	return ret;
+}
+
+static int stsafe_i2c_flush(struct stsafe_i2c_ctx *ctx)
+{
+	if (ctx->num_msgs == 0) {
+		return -EINVAL;
+	}
+	ctx->msgs[ctx->num_msgs - 1].flags |= I2C_MSG_STOP;
+	return i2c_transfer(ctx->i2c_bus, ctx->msgs, ctx->num_msgs, ctx->i2c_addr);
+}
+#endif /* CONFIG_STSAFE_I2C_ZERO_COPY */
+
+static uint8_t stsafe_i2c_header(const struct stsafe_i2c_ctx *ctx)
+{
+#ifdef CONFIG_STSAFE_I2C_ZERO_COPY
+	return ctx->num_msgs != 0 ? ctx->msgs[0].buf[0] : 0;
+#else
+	return ctx->buffer[0];
+#endif
+}
+
+#if defined(CONFIG_STSAFE_FRAME_TRACE) || defined(CONFIG_STSAFE_CAPTURE)
+/* Copy the start of the frame just moved, from wherever it is */
+static uint16_t stsafe_i2c_frame_copy(const struct stsafe_i2c_ctx *ctx, uint8_t *dst, uint16_t max)
+{
+	uint16_t n = 0;
+
+#ifdef CONFIG_STSAFE_I2C_ZERO_COPY
+	for (uint8_t i = 0; i < ctx->num_msgs && n < max; i++) {
+		uint16_t chunk = MIN(ctx->msgs[i].len, max - n);
+
+		memcpy(dst + n, ctx->msgs[i].buf, chunk);
+		n += chunk;
+	}
+	if (ctx->num_msgs != 0) {
+		return n;
+	}
+#endif
+	n = MIN(ctx->frame_size, max);
+	memcpy(dst, ctx->buffer, n);
+	return n;
+}
+#endif
+
+#ifdef CONFIG_STSAFE_FRAME_TRACE
+static void stsafe_i2c_trace(const struct stsafe_i2c_ctx *ctx, enum stsafe_trace_dir dir)
+{
+	/* The header is kept even when no payload is */
+	uint8_t prefix[MAX(CONFIG_STSAFE_FRAME_TRACE_PAYLOAD, 1)];
+	uint8_t n = stsafe_i2c_frame_copy(ctx, prefix, sizeof(prefix));
+
+	stse_trace_frame(ctx->bus_id, dir, n != 0 ? prefix[0] : 0, ctx->frame_size, prefix, n);
+}
+#endif
+
+#ifdef CONFIG_STSAFE_CAPTURE
+static void stsafe_i2c_capture(const struct stsafe_i2c_ctx *ctx, uint8_t dir)
+{
+	uint8_t *dst = stse_capture_claim(ctx->bus_id, dir, ctx->frame_size);
+
+	if (dst != NULL) {
+		stsafe_i2c_frame_copy(ctx, dst, ctx->frame_size);
+	}
+}
+#endif
+
+/* A hibernating chip wakes up on its address; it NACKs until it has booted */
 stse_ReturnCode_t stse_platform_i2c_wake(PLAT_UI8 busID, PLAT_UI8 devAddr, PLAT_UI16 speed)
 {
+	if (busID >= ARRAY_SIZE(ctx_table) || ctx_table[busID] == NULL) {
+		LOG_ERR("invalid busID %u", busID);
+		return STSE_PLATFORM_BUFFER_ERR;
+	}
+	struct stsafe_i2c_ctx *ctx = ctx_table[busID];
+	uint8_t dummy = 0;
+
+	(void)i2c_write(ctx->i2c_bus, &dummy, 0, ctx->i2c_addr);
 	return STSE_OK;
 }
 
 stse_ReturnCode_t stse_platform_i2c_init(PLAT_UI8 busID, void *pArg)
 {
-	if (busID >= CONFIG_STSAFE_MAX_INSTANCES) {
-		LOG_ERR("busID %u out of range (max %u)", busID, CONFIG_STSAFE_MAX_INSTANCES);
+	if (busID >= ARRAY_SIZE(ctx_table)) {
+		LOG_ERR("busID %u out of range (max %zu)", busID, ARRAY_SIZE(ctx_table));
 		return STSE_PLATFORM_BUFFER_ERR;
 	}
 	if (pArg == NULL) {
@@ -62,10 +230,25 @@ stse_ReturnCode_t stse_platform_i2c_init(PLAT_UI8 busID, void *pArg)
 	const struct device *stsafe_dev = (const struct device *)pArg;
 	const struct stsafe_config *cfg = stsafe_dev->config;
 
-	ctx_table[busID].i2c_bus = cfg->i2c.bus;
-	ctx_table[busID].i2c_addr = cfg->i2c.addr;
-	ctx_table[busID].used = true;
-	ctx_table[busID].bus_id = cfg->bus_id;
+	struct stsafe_i2c_ctx *ctx = cfg->i2c_ctx;
+
+	ctx->i2c_bus = cfg->i2c.bus;
+	ctx->i2c_addr = cfg->i2c.addr;
+	ctx->bus_id = cfg->bus_id;
+	ctx->device_type = cfg->device_type;
+#if defined(CONFIG_STSE_USE_HOST_SESSION) && !defined(CONFIG_STSE_HOST_KEY_VOLATILE)
+	for (size_t i = 0; i < ARRAY_SIZE(ctx_table); i++) {
+		if (ctx_table[i] != NULL && ctx_table[i] != ctx &&
+		    ctx_table[i]->host_key_set == ctx->host_key_set) {
+			LOG_WRN("%s: host-key-set %u also used by bus_id=%d", stsafe_dev->name,
+				ctx->host_key_set, ctx_table[i]->bus_id);
+		}
+	}
+#endif
+	ctx_table[busID] = ctx;
+#ifdef CONFIG_STSAFE_STATS
+	stse_stats_register(&ctx->stats, stsafe_dev->name);
+#endif
 
 	LOG_DBG("%s: i2c_init bus_id=%u addr=0x%02x", stsafe_dev->name, busID, cfg->i2c.addr);
 	return STSE_OK;
@@ -74,27 +257,40 @@ stse_ReturnCode_t stse_platform_i2c_init(PLAT_UI8 busID, void *pArg)
 stse_ReturnCode_t stse_platform_i2c_send_start(PLAT_UI8 busID, PLAT_UI8 devAddr, PLAT_UI16 speed,
 					       const PLAT_UI16 frameLength)
 {
-	if (busID >= CONFIG_STSAFE_MAX_INSTANCES || !ctx_table[busID].used) {
+	if (busID >= ARRAY_SIZE(ctx_table) || ctx_table[busID] == NULL) {
 		LOG_ERR("invalid busID %u", busID);
 		return STSE_PLATFORM_BUFFER_ERR;
 	}
-	struct stsafe_i2c_ctx *ctx = &ctx_table[busID];
+	struct stsafe_i2c_ctx *ctx = ctx_table[busID];
 
-	if (frameLength > STSAFE_I2C_BUFFER_SIZE) {
-		LOG_ERR("frame length %u exceeds buffer size %u", frameLength,
-			STSAFE_I2C_BUFFER_SIZE);
+#ifdef CONFIG_STSAFE_FRAME_ARENA
+	if (ctx->buffer == NULL) {
+		LOG_ERR("no frame buffer on bus_id=%u (device not acquired)", busID);
+		return STSE_PLATFORM_BUFFER_ERR;
+	}
+#endif
+	if (frameLength > ctx->frame_max) {
+		LOG_ERR("frame length %u exceeds maximum frame size %u", frameLength,
+			ctx->frame_max);
 		return STSE_PLATFORM_BUFFER_ERR;
 	}
+	stsafe_i2c_addressing(ctx);
 	ctx->frame_size = frameLength;
 	ctx->frame_offset = 0;
+#ifdef CONFIG_STSAFE_I2C_ZERO_COPY
+	ctx->num_msgs = 0;
+#endif
 	return STSE_OK;
 }
 
 stse_ReturnCode_t stse_platform_i2c_send_continue(PLAT_UI8 busID, PLAT_UI8 devAddr, PLAT_UI16 speed,
 						  PLAT_UI8 *pData, PLAT_UI16 data_size)
 {
-	struct stsafe_i2c_ctx *ctx = &ctx_table[busID];
+	struct stsafe_i2c_ctx *ctx = ctx_table[busID];
 
+#ifdef CONFIG_STSAFE_I2C_ZERO_COPY
+	return stsafe_i2c_add_fragment(ctx, pData, data_size, I2C_MSG_WRITE);
+#else
 	if (data_size != 0) {
 		if (pData == NULL) {
 			memset(ctx->buffer + ctx->frame_offset, 0x00, data_size);
@@ -104,26 +300,51 @@ stse_ReturnCode_t stse_platform_i2c_send_continue(PLAT_UI8 busID, PLAT_UI8 devAd
 		ctx->frame_offset += data_size;
 	}
 	return STSE_OK;
+#endif
 }
 
 stse_ReturnCode_t stse_platform_i2c_send_stop(PLAT_UI8 busID, PLAT_UI8 devAddr, PLAT_UI16 speed,
 					      PLAT_UI8 *pData, PLAT_UI16 data_size)
 {
-	struct stsafe_i2c_ctx *ctx = &ctx_table[busID];
+	struct stsafe_i2c_ctx *ctx = ctx_table[busID];
 
 	stse_ReturnCode_t ret =
 		stse_platform_i2c_send_continue(busID, ctx->i2c_addr, speed, pData, data_size);
 	if (ret == STSE_OK) {
+#ifdef CONFIG_STSAFE_I2C_ZERO_COPY
+		ret = stsafe_i2c_flush(ctx);
+#else
 		ret = i2c_write(ctx->i2c_bus, ctx->buffer, ctx->frame_size, ctx->i2c_addr);
+#endif
 	}
 	if (ret != STSE_OK) {
 		LOG_ERR("failed to send frame on bus_id=%u addr=0x%02x: %d", busID, ctx->i2c_addr,
 			ret);
+#ifdef CONFIG_STSAFE_STATS
+		stse_stats_tx_error(&ctx->stats);
+#endif
+#ifdef CONFIG_STSAFE_FRAME_TRACE
+		stsafe_i2c_trace(ctx, STSAFE_TRACE_TX_ERROR);
+#endif
 		return STSE_PLATFORM_BUS_ACK_ERROR;
 	}
 
-	LOG_DBG("frame sent successfully on bus_id=%u addr=0x%02x, length=%u", busID, ctx->i2c_addr,
-		ctx->frame_size);
+#ifdef CONFIG_STSAFE_STATS
+	stse_stats_cmd_sent(&ctx->stats, stsafe_i2c_header(ctx), ctx->frame_size);
+#endif
+#ifdef CONFIG_STSAFE_FRAME_TRACE
+	stsafe_i2c_trace(ctx, STSAFE_TRACE_TX);
+#endif
+#ifdef CONFIG_STSAFE_CAPTURE
+	stsafe_i2c_capture(ctx, STSAFE_CAPTURE_CMD);
+#endif
+
+#ifdef CONFIG_STSE_ADAPTIVE_POLLING
+	stse_polling_cmd_sent(&ctx->polling, STSAFE_DEVICE_TYPE(ctx), stsafe_i2c_header(ctx));
+#endif
+
+	STSE_FRAME_LOG_DBG("frame sent successfully on bus_id=%u addr=0x%02x, length=%u", busID,
+			   ctx->i2c_addr, ctx->frame_size);
 	return ret;
 }
 
@@ -132,21 +353,68 @@ stse_ReturnCode_t stse_platform_i2c_receive_start(PLAT_UI8 busID, PLAT_UI8 devAd
 {
 	(void)devAddr;
 	(void)speed;
-	struct stsafe_i2c_ctx *ctx = &ctx_table[busID];
+	struct stsafe_i2c_ctx *ctx = ctx_table[busID];
 
-	if (frameLength > STSAFE_I2C_BUFFER_SIZE) {
+	if (ctx == NULL || frameLength > ctx->frame_max) {
+		return STSE_PLATFORM_BUFFER_ERR;
+	}
+#ifdef CONFIG_STSAFE_FRAME_ARENA
+	if (ctx->buffer == NULL) {
+		LOG_ERR("no frame buffer on bus_id=%u (device not acquired)", busID);
 		return STSE_PLATFORM_BUFFER_ERR;
 	}
+#endif
 
 	ctx->frame_size = frameLength;
+	ctx->frame_offset = 0;
+
+#ifdef CONFIG_STSAFE_I2C_ZERO_COPY
+	ctx->num_msgs = 0;
+	ctx->deferred = frameLength > ctx->buffer_size;
+	if (ctx->deferred) {
+		/*
+		 * The length probe already saw the chip ACK: the frame itself is
+		 * read straight into the caller's buffers in receive_stop.
+		 */
+		return STSE_OK;
+	}
+#endif
 
 	int ret = i2c_read(ctx->i2c_bus, ctx->buffer, ctx->frame_size, ctx->i2c_addr);
 	if (ret != 0) {
-		LOG_ERR("i2c_read failed on bus_id=%u addr=0x%02x: %d", busID, ctx->i2c_addr, ret);
+		/* Expected while the chip is still computing: STSELib polls again */
+		STSE_FRAME_LOG_DBG("i2c_read failed on bus_id=%u addr=0x%02x: %d", busID,
+				   ctx->i2c_addr, ret);
+#ifdef CONFIG_STSAFE_STATS
+		stse_stats_nack(&ctx->stats);
+#endif
+#ifdef CONFIG_STSAFE_FRAME_TRACE
+		stse_trace_frame(ctx->bus_id, STSAFE_TRACE_NACK, 0, ctx->frame_size, NULL, 0);
+#endif
+#ifdef CONFIG_STSAFE_CAPTURE
+		/* Bounds from below when the chip finished, for a replay */
+		(void)stse_capture_claim(ctx->bus_id, STSAFE_CAPTURE_NACK, 0);
+#endif
 		return STSE_PLATFORM_BUS_ACK_ERROR;
 	}
 
-	ctx->frame_offset = 0;
+#ifdef CONFIG_STSAFE_STATS
+	stse_stats_rx(&ctx->stats, ctx->frame_size);
+#endif
+#ifdef CONFIG_STSAFE_FRAME_TRACE
+	stsafe_i2c_trace(ctx, STSAFE_TRACE_RX);
+#endif
+#ifdef CONFIG_STSAFE_CAPTURE
+	stsafe_i2c_capture(ctx, STSAFE_CAPTURE_RSP);
+#endif
+
+#ifdef CONFIG_STSE_ADAPTIVE_POLLING
+	stse_polling_rsp_received(&ctx->polling);
+#endif
+#ifdef CONFIG_STSE_CRC16_FUSED_RX
+	stse_crc16_rx_begin(&ctx->crc_rx);
+#endif
+
 	return STSE_OK;
 }
 
@@ -156,13 +424,23 @@ stse_ReturnCode_t stse_platform_i2c_receive_continue(PLAT_UI8 busID, PLAT_UI8 de
 {
 	(void)devAddr;
 	(void)speed;
-	struct stsafe_i2c_ctx *ctx = &ctx_table[busID];
+	struct stsafe_i2c_ctx *ctx = ctx_table[busID];
+
+#ifdef CONFIG_STSAFE_I2C_ZERO_COPY
+	if (ctx->deferred) {
+		return stsafe_i2c_add_fragment(ctx, pData, data_size, I2C_MSG_READ);
+	}
+#endif
 
 	if (pData != NULL) {
 		if ((ctx->frame_size - ctx->frame_offset) < data_size) {
 			return STSE_PLATFORM_BUFFER_ERR;
 		}
+#ifdef CONFIG_STSE_CRC16_FUSED_RX
+		stse_crc16_rx_copy(&ctx->crc_rx, pData, ctx->buffer + ctx->frame_offset, data_size);
+#else
 		memcpy(pData, ctx->buffer + ctx->frame_offset, data_size);
+#endif
 	}
 	ctx->frame_offset += data_size;
 	return STSE_OK;
@@ -171,14 +449,43 @@ stse_ReturnCode_t stse_platform_i2c_receive_continue(PLAT_UI8 busID, PLAT_UI8 de
 stse_ReturnCode_t stse_platform_i2c_receive_stop(PLAT_UI8 busID, PLAT_UI8 devAddr, PLAT_UI16 speed,
 						 PLAT_UI8 *pData, PLAT_UI16 data_size)
 {
-	struct stsafe_i2c_ctx *ctx = &ctx_table[busID];
+	struct stsafe_i2c_ctx *ctx = ctx_table[busID];
+
+#ifdef CONFIG_STSAFE_I2C_ZERO_COPY
+	if (ctx->deferred) {
+		stse_ReturnCode_t ret =
+			stsafe_i2c_add_fragment(ctx, pData, data_size, I2C_MSG_READ);
+
+		if (ret == STSE_OK && stsafe_i2c_flush(ctx) != 0) {
+			LOG_ERR("failed to read frame on bus_id=%u addr=0x%02x", busID,
+				ctx->i2c_addr);
+			ret = STSE_PLATFORM_BUS_ACK_ERROR;
+		}
+		ctx->frame_offset = 0;
+		if (ret != STSE_OK) {
+			return ret;
+		}
+#ifdef CONFIG_STSAFE_STATS
+		stse_stats_rx(&ctx->stats, ctx->frame_size);
+#endif
+#ifdef CONFIG_STSAFE_FRAME_TRACE
+		stsafe_i2c_trace(ctx, STSAFE_TRACE_RX);
+#endif
+#ifdef CONFIG_STSAFE_CAPTURE
+		stsafe_i2c_capture(ctx, STSAFE_CAPTURE_RSP);
+#endif
+		STSE_FRAME_LOG_DBG("frame received on bus_id=%u addr=0x%02x, length=%u", busID,
+				   ctx->i2c_addr, ctx->frame_size);
+		return STSE_OK;
+	}
+#endif
 
 	if (pData != NULL) {
 		memcpy(pData, ctx->buffer + ctx->frame_offset, data_size);
 	}
 	ctx->frame_offset = 0;
 
-	LOG_DBG("frame received successfully on bus_id=%u addr=0x%02x, length=%u", busID,
-		ctx->i2c_addr, ctx->frame_size);
+	STSE_FRAME_LOG_DBG("frame received successfully on bus_id=%u addr=0x%02x, length=%u", busID,
+			   ctx->i2c_addr, ctx->frame_size);
 	return STSE_OK;
 }
@@ -11,6 +11,8 @@
 LOG_MODULE_DECLARE(stsafe, CONFIG_STSAFE_LOG_LEVEL);
 
 #include "stse_aes.h"
+#include "stse_i2c.h"
+#include "../stsafe_priv.h"
 
 static void secure_zero(void *ptr, size_t len)
 {
@@ -21,6 +23,65 @@ static void secure_zero(void *ptr, size_t len)
 	LOG_DBG("securely zeroed %zu bytes at %p", len, ptr);
 }
 
+#ifdef CONFIG_STSE_HOST_KEY_VOLATILE
+/*
+ * Volatile mode: the host keys only live in the PSA keystore RAM. Their IDs
+ * are assigned by psa_import_key() and cached here, so STSELib gets them as
+ * key indices and no lookup or storage access is needed afterwards. There is
+ * one set per instance, picked by the chip the calling thread last addressed,
+ * so a session opened on one instance leaves the keys of the others alone.
+ * The last set is for callers that never addressed a chip.
+ */
+struct host_key_set {
+	psa_key_id_t cmac;
+	psa_key_id_t cbc;
+	psa_key_id_t ecb;
+};
+
+static struct host_key_set host_keys[STSAFE_NUM_INSTANCES + 1];
+
+static struct host_key_set *addressed_keys(void)
+{
+	const struct stsafe_i2c_ctx *ctx = stse_i2c_addressed();
+
+	return &host_keys[ctx != NULL ? ctx->bus_id : STSAFE_NUM_INSTANCES];
+}
+
+static void destroy_cached_key(psa_key_id_t *id)
+{
+	if (*id != PSA_KEY_ID_NULL) {
+		psa_destroy_key(*id);
+		*id = PSA_KEY_ID_NULL;
+	}
+}
+
+static int store_volatile_key(psa_key_id_t *id, psa_key_type_t type, size_t bits,
+			      psa_algorithm_t alg, psa_key_usage_t usage, const uint8_t *key_data,
+			      size_t key_data_len)
+{
+	psa_status_t ret;
+	psa_key_attributes_t attr = PSA_KEY_ATTRIBUTES_INIT;
+
+	/* A new session key of the same instance replaces the previous one */
+	destroy_cached_key(id);
+
+	psa_set_key_lifetime(&attr, PSA_KEY_LIFETIME_VOLATILE);
+	psa_set_key_type(&attr, type);
+	psa_set_key_bits(&attr, bits);
+	psa_set_key_algorithm(&attr, alg);
+	psa_set_key_usage_flags(&attr, usage);
+
+	ret = psa_import_key(&attr, key_data, key_data_len, id);
+	if (ret != PSA_SUCCESS) {
+		LOG_ERR("Failed to import volatile key: %d", ret);
+		*id = PSA_KEY_ID_NULL;
+		return -1;
+	}
+
+	LOG_DBG("Imported volatile key 0x%x", *id);
+	return 0;
+}
+#else
 static int store_persistent_key(psa_key_id_t id, psa_key_type_t type, size_t bits,
 				psa_algorithm_t alg, psa_key_usage_t usage, const uint8_t *key_data,
 				size_t key_data_len)
@@ -56,6 +117,103 @@ static int store_persistent_key(psa_key_id_t id, psa_key_type_t type, size_t bit
 	return 0;
 }
 
+/* Slot of a persistent key ID, or -1 if it is not one of the host keys */
+static int persistent_key_slot(uint32_t id, int offset)
+{
+	if (id < ITS_BASE_ADDR || (id - ITS_BASE_ADDR) % STSE_ITS_KEYS_PER_SLOT != offset) {
+		return -1;
+	}
+
+	uint32_t slot = (id - ITS_BASE_ADDR) / STSE_ITS_KEYS_PER_SLOT;
+
+	return slot < STSAFE_HOST_KEY_SETS ? (int)slot : -1;
+}
+
+/*
+ * Persistent keys live at the IDs of the host-key-set of the chip the calling
+ * thread last addressed, a devicetree property, so that they stay with their
+ * chip whatever the other instances. Set 0 is the legacy single chip IDs,
+ * also used by callers that never addressed a chip.
+ */
+static int addressed_key_slot(void)
+{
+	const struct stsafe_i2c_ctx *ctx = stse_i2c_addressed();
+
+	return ctx != NULL ? ctx->host_key_set : 0;
+}
+#endif /* CONFIG_STSE_HOST_KEY_VOLATILE */
+
+#ifdef CONFIG_STSE_HOST_KEY_VOLATILE
+static int store_mac_key(const uint8_t *key, size_t key_length, PLAT_UI32 *pKey_idx)
+{
+	struct host_key_set *keys = addressed_keys();
+	int ret = store_volatile_key(&keys->cmac, PSA_KEY_TYPE_AES, key_length * 8, PSA_ALG_CMAC,
+				     PSA_KEY_USAGE_SIGN_MESSAGE | PSA_KEY_USAGE_VERIFY_MESSAGE, key,
+				     key_length);
+
+	*pKey_idx = keys->cmac;
+	return ret;
+}
+
+static int store_cipher_keys(const uint8_t *key, size_t key_length, PLAT_UI32 *pKey_idx)
+{
+	struct host_key_set *keys = addressed_keys();
+	int ret = store_volatile_key(&keys->cbc, PSA_KEY_TYPE_AES, key_length * 8,
+				     PSA_ALG_CBC_NO_PADDING,
+				     PSA_KEY_USAGE_ENCRYPT | PSA_KEY_USAGE_DECRYPT, key,
+				     key_length);
+	if (ret != 0) {
+		return ret;
+	}
+
+	ret = store_volatile_key(&keys->ecb, PSA_KEY_TYPE_AES, key_length * 8,
+				 PSA_ALG_ECB_NO_PADDING,
+				 PSA_KEY_USAGE_ENCRYPT | PSA_KEY_USAGE_DECRYPT, key, key_length);
+	if (ret != 0) {
+		destroy_cached_key(&keys->cbc);
+		return ret;
+	}
+
+	*pKey_idx = keys->cbc;
+	return 0;
+}
+#else
+static int store_mac_key(const uint8_t *key, size_t key_length, PLAT_UI32 *pKey_idx)
+{
+	int slot = addressed_key_slot();
+	int ret = store_persistent_key(STSE_ITS_ID_KEY_CMAC_AT(slot), PSA_KEY_TYPE_AES,
+				       key_length * 8, PSA_ALG_CMAC,
+				       PSA_KEY_USAGE_SIGN_MESSAGE | PSA_KEY_USAGE_VERIFY_MESSAGE,
+				       key, key_length);
+
+	*pKey_idx = STSE_ITS_ID_KEY_CMAC_AT(slot);
+	return ret;
+}
+
+static int store_cipher_keys(const uint8_t *key, size_t key_length, PLAT_UI32 *pKey_idx)
+{
+	int slot = addressed_key_slot();
+	int ret = store_persistent_key(STSE_ITS_ID_KEY_CBC_AT(slot), PSA_KEY_TYPE_AES,
+				       key_length * 8, PSA_ALG_CBC_NO_PADDING,
+				       PSA_KEY_USAGE_ENCRYPT | PSA_KEY_USAGE_DECRYPT, key,
+				       key_length);
+	if (ret != 0) {
+		return ret;
+	}
+
+	ret = store_persistent_key(STSE_ITS_ID_KEY_ECB_AT(slot), PSA_KEY_TYPE_AES, key_length * 8,
+				   PSA_ALG_ECB_NO_PADDING,
+				   PSA_KEY_USAGE_ENCRYPT | PSA_KEY_USAGE_DECRYPT, key, key_length);
+	if (ret != 0) {
+		psa_destroy_key(STSE_ITS_ID_KEY_CBC_AT(slot));
+		return ret;
+	}
+
+	*pKey_idx = STSE_ITS_ID_KEY_CBC_AT(slot);
+	return 0;
+}
+#endif /* CONFIG_STSE_HOST_KEY_VOLATILE */
+
 stse_ReturnCode_t stse_platform_store_aes_key(PLAT_UI8 *pKey, PLAT_UI16 key_length,
 					      stse_aes_key_usage_t usage, PLAT_UI32 *pKey_idx)
 {
@@ -71,35 +229,17 @@ stse_ReturnCode_t stse_platform_store_aes_key(PLAT_UI8 *pKey, PLAT_UI16 key_leng
 	int ret = 0;
 
 	if (usage == STSE_AES_KEY_USAGE_MAC) {
-		ret = store_persistent_key(
-			STSE_ITS_ID_KEY_CMAC, PSA_KEY_TYPE_AES, key_length * 8, PSA_ALG_CMAC,
-			PSA_KEY_USAGE_SIGN_MESSAGE | PSA_KEY_USAGE_VERIFY_MESSAGE, pKey,
-			key_length);
+		ret = store_mac_key(pKey, key_length, pKey_idx);
 		if (ret != 0) {
 			LOG_ERR("Failed to store MAC key: %d", ret);
 			return STSE_SESSION_ERROR;
 		}
-		*pKey_idx = STSE_ITS_ID_KEY_CMAC;
 	} else {
-		ret = store_persistent_key(STSE_ITS_ID_KEY_CBC, PSA_KEY_TYPE_AES, key_length * 8,
-					   PSA_ALG_CBC_NO_PADDING,
-					   PSA_KEY_USAGE_ENCRYPT | PSA_KEY_USAGE_DECRYPT, pKey,
-					   key_length);
-		if (ret != 0) {
-			LOG_ERR("Failed to store CBC key: %d", ret);
-			return STSE_SESSION_ERROR;
-		}
-
-		ret = store_persistent_key(STSE_ITS_ID_KEY_ECB, PSA_KEY_TYPE_AES, key_length * 8,
-					   PSA_ALG_ECB_NO_PADDING,
-					   PSA_KEY_USAGE_ENCRYPT | PSA_KEY_USAGE_DECRYPT, pKey,
-					   key_length);
+		ret = store_cipher_keys(pKey, key_length, pKey_idx);
 		if (ret != 0) {
-			psa_destroy_key(STSE_ITS_ID_KEY_CBC);
-			LOG_ERR("Failed to store ECB key: %d", ret);
+			LOG_ERR("Failed to store cipher keys: %d", ret);
 			return STSE_SESSION_ERROR;
 		}
-		*pKey_idx = STSE_ITS_ID_KEY_CIPHER;
 	}
 
 	secure_zero(pKey, key_length);
@@ -107,20 +247,58 @@ stse_ReturnCode_t stse_platform_store_aes_key(PLAT_UI8 *pKey, PLAT_UI16 key_leng
 	return STSE_OK;
 }
 
+psa_key_id_t stse_aes_ecb_key(uint32_t cipher_key_idx)
+{
+#ifdef CONFIG_STSE_HOST_KEY_VOLATILE
+	for (size_t i = 0; i < ARRAY_SIZE(host_keys); i++) {
+		if (cipher_key_idx == host_keys[i].cbc && host_keys[i].cbc != PSA_KEY_ID_NULL) {
+			return host_keys[i].ecb;
+		}
+	}
+#else
+	int slot = persistent_key_slot(cipher_key_idx, 1);
+
+	if (slot >= 0) {
+		return STSE_ITS_ID_KEY_ECB_AT(slot);
+	}
+#endif
+	return PSA_KEY_ID_NULL;
+}
+
 stse_ReturnCode_t stse_platform_delete_key(PLAT_UI32 CypherKeyIdx, PLAT_UI32 MACKeyIdx)
 {
-	if (CypherKeyIdx != STSE_ITS_ID_KEY_CBC || MACKeyIdx != STSE_ITS_ID_KEY_CMAC) {
-		LOG_DBG("Invalid key indices: CypherKeyIdx=%u (expected %u), "
-			"MACKeyIdx=%u (expected %u)",
-			CypherKeyIdx, STSE_ITS_ID_KEY_CBC, MACKeyIdx, STSE_ITS_ID_KEY_CMAC);
+#ifdef CONFIG_STSE_HOST_KEY_VOLATILE
+	/* Only the set these keys belong to: the other instances keep their sessions */
+	for (size_t i = 0; i < ARRAY_SIZE(host_keys); i++) {
+		struct host_key_set *keys = &host_keys[i];
+
+		if (CypherKeyIdx == keys->cbc && MACKeyIdx == keys->cmac &&
+		    keys->cbc != PSA_KEY_ID_NULL) {
+			destroy_cached_key(&keys->cmac);
+			destroy_cached_key(&keys->cbc);
+			destroy_cached_key(&keys->ecb);
+			LOG_DBG("Destroyed volatile host keys of slot %zu", i);
+			return STSE_OK;
+		}
+	}
+
+	LOG_DBG("Invalid key indices: CypherKeyIdx=%u, MACKeyIdx=%u", CypherKeyIdx, MACKeyIdx);
+	return STSE_OK;
+#else
+	int slot = persistent_key_slot(CypherKeyIdx, 1);
+
+	if (slot < 0 || MACKeyIdx != STSE_ITS_ID_KEY_CMAC_AT(slot)) {
+		LOG_DBG("Invalid key indices: CypherKeyIdx=%u, MACKeyIdx=%u", CypherKeyIdx,
+			MACKeyIdx);
 		return STSE_OK;
 	}
 
-	psa_destroy_key(STSE_ITS_ID_KEY_CMAC);
-	psa_destroy_key(STSE_ITS_ID_KEY_CBC);
-	psa_destroy_key(STSE_ITS_ID_KEY_ECB);
+	psa_destroy_key(STSE_ITS_ID_KEY_CMAC_AT(slot));
+	psa_destroy_key(STSE_ITS_ID_KEY_CBC_AT(slot));
+	psa_destroy_key(STSE_ITS_ID_KEY_ECB_AT(slot));
 
 	LOG_DBG("Successfully deleted keys with indices: CypherKeyIdx=%u, MACKeyIdx=%u",
 		CypherKeyIdx, MACKeyIdx);
 	return STSE_OK;
+#endif /* CONFIG_STSE_HOST_KEY_VOLATILE */
 }
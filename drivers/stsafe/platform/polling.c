@@ -0,0 +1,251 @@
+/*
+ * Copyright (c) 2026, CATIE
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/slist.h>
+
+#ifdef CONFIG_STSE_ADAPTIVE_POLLING_SETTINGS
+#include <zephyr/settings/settings.h>
+#endif
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_DECLARE(stsafe, CONFIG_STSAFE_LOG_LEVEL);
+
+#include "stselib.h"
+#include "stse_polling.h"
+
+#define STSE_POLLING_CMD_MASK  0x1F
+#define STSE_POLLING_CMD_COUNT 32
+#define STSE_POLLING_VARIANTS  2
+#define STSE_POLLING_MIN_US    200U
+
+/* Time the fixed schedule gives a command before STSELib gives up */
+#define STSE_POLLING_BUDGET_US                                                                     \
+	((CONFIG_STSE_FIRST_POLLING_INTERVAL +                                                     \
+	  CONFIG_STSE_MAX_POLLING_RETRY * CONFIG_STSE_POLLING_RETRY_INTERVAL) *                    \
+	 USEC_PER_MSEC)
+
+/*
+ * Seed completion times in microseconds, from the datasheet typical
+ * execution times. Commands left at 0 start from
+ * CONFIG_STSE_FIRST_POLLING_INTERVAL. The table is refined at runtime.
+ */
+#define STSE_POLLING_SEEDS                                                                         \
+	{                                                                                          \
+		[0x00] = 1000,  /* echo */                                                         \
+		[0x01] = 5000,  /* reset */                                                        \
+		[0x02] = 3000,  /* generate random */                                              \
+		[0x03] = 10000, /* start session */                                                \
+		[0x04] = 10000, /* decrement */                                                    \
+		[0x05] = 3000,  /* read */                                                         \
+		[0x06] = 10000, /* update */                                                       \
+		[0x0D] = 2000,  /* hibernate */                                                    \
+		[0x11] = 80000, /* generate key */                                                 \
+		[0x14] = 2000,  /* query */                                                        \
+		[0x16] = 50000, /* generate signature */                                           \
+		[0x17] = 90000, /* verify signature */                                             \
+		[0x18] = 60000, /* establish key */                                                \
+	}
+
+static uint32_t stse_polling_table[STSE_POLLING_VARIANTS][STSE_POLLING_CMD_COUNT] = {
+	STSE_POLLING_SEEDS,
+	STSE_POLLING_SEEDS,
+};
+
+static struct k_spinlock stse_polling_lock;
+static sys_slist_t stse_polling_pending = SYS_SLIST_STATIC_INIT(&stse_polling_pending);
+
+#ifdef CONFIG_STSE_ADAPTIVE_POLLING_SETTINGS
+static const char *const stse_polling_keys[STSE_POLLING_VARIANTS] = {"a110", "a120"};
+
+/* Table as last saved or loaded, a save is only scheduled once an entry drifts from it */
+static uint32_t stse_polling_saved[STSE_POLLING_VARIANTS][STSE_POLLING_CMD_COUNT] = {
+	STSE_POLLING_SEEDS,
+	STSE_POLLING_SEEDS,
+};
+
+static bool stse_polling_drifted(uint32_t est, uint32_t saved)
+{
+	uint32_t diff = est > saved ? est - saved : saved - est;
+
+	return diff * 100U > saved * CONFIG_STSE_ADAPTIVE_POLLING_SAVE_DRIFT;
+}
+
+static void stse_polling_save_handler(struct k_work *work)
+{
+	uint32_t table[STSE_POLLING_CMD_COUNT];
+	char key[sizeof("stsafe/poll/a1xx")];
+
+	for (int v = 0; v < STSE_POLLING_VARIANTS; v++) {
+		K_SPINLOCK(&stse_polling_lock) {
+			memcpy(table, stse_polling_table[v], sizeof(table));
+			memcpy(stse_polling_saved[v], table, sizeof(table));
+		}
+		snprintk(key, sizeof(key), "stsafe/poll/%s", stse_polling_keys[v]);
+		int ret = settings_save_one(key, table, sizeof(table));
+		if (ret != 0) {
+			LOG_WRN("failed to save polling table %s: %d", key, ret);
+		}
+	}
+}
+
+static K_WORK_DELAYABLE_DEFINE(stse_polling_save_work, stse_polling_save_handler);
+
+static int stse_polling_settings_set(const char *name, size_t len, settings_read_cb read_cb,
+				     void *cb_arg)
+{
+	const char *next;
+
+	for (int v = 0; v < STSE_POLLING_VARIANTS; v++) {
+		if (!settings_name_steq(name, stse_polling_keys[v], &next) || next != NULL) {
+			continue;
+		}
+		if (len != sizeof(stse_polling_table[v])) {
+			return -EINVAL;
+		}
+
+		uint32_t table[STSE_POLLING_CMD_COUNT];
+		ssize_t ret = read_cb(cb_arg, table, sizeof(table));
+		if (ret < 0) {
+			return ret;
+		}
+		K_SPINLOCK(&stse_polling_lock) {
+			memcpy(stse_polling_table[v], table, sizeof(table));
+			memcpy(stse_polling_saved[v], table, sizeof(table));
+		}
+		LOG_DBG("loaded polling table %s", stse_polling_keys[v]);
+		return 0;
+	}
+	return -ENOENT;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(stse_polling, "stsafe/poll", NULL, stse_polling_settings_set, NULL,
+			       NULL);
+#endif /* CONFIG_STSE_ADAPTIVE_POLLING_SETTINGS */
+
+static uint32_t stse_polling_estimate(const struct stse_polling *p)
+{
+	uint32_t est = stse_polling_table[p->variant][p->cmd];
+
+	return est != 0 ? est : CONFIG_STSE_FIRST_POLLING_INTERVAL * USEC_PER_MSEC;
+}
+
+void stse_polling_cmd_sent(struct stse_polling *p, uint8_t device_type, uint8_t header)
+{
+	K_SPINLOCK(&stse_polling_lock) {
+		if (!p->pending) {
+			sys_slist_append(&stse_polling_pending, &p->node);
+			p->pending = true;
+		}
+		p->owner = k_current_get();
+		p->sent_at = k_cycle_get_32();
+		p->variant = device_type == STSAFE_A120 ? 1 : 0;
+		p->cmd = header & STSE_POLLING_CMD_MASK;
+		p->retries = 0;
+	}
+}
+
+void stse_polling_rsp_received(struct stse_polling *p)
+{
+	bool changed = false;
+
+	K_SPINLOCK(&stse_polling_lock) {
+		if (!p->pending) {
+			K_SPINLOCK_BREAK;
+		}
+		sys_slist_find_and_remove(&stse_polling_pending, &p->node);
+		p->pending = false;
+
+		uint32_t *est = &stse_polling_table[p->variant][p->cmd];
+		uint32_t observed = k_cyc_to_us_floor32(k_cycle_get_32() - p->sent_at);
+
+		if (p->retries <= 1) {
+			/* Ready at the first poll: probe a little earlier next time */
+			uint32_t cur = stse_polling_estimate(p);
+
+			*est = MAX(cur - (cur >> CONFIG_STSE_ADAPTIVE_POLLING_SHRINK_SHIFT),
+				   STSE_POLLING_MIN_US);
+		} else {
+			/* Missed: the observed time is an upper bound by one step */
+			*est = MAX(observed, STSE_POLLING_MIN_US);
+		}
+#ifdef CONFIG_STSE_ADAPTIVE_POLLING_SETTINGS
+		changed = stse_polling_drifted(*est, stse_polling_saved[p->variant][p->cmd]);
+#endif
+	}
+
+#ifdef CONFIG_STSE_ADAPTIVE_POLLING_SETTINGS
+	if (changed) {
+		/* Does nothing if a save is already scheduled */
+		k_work_schedule(&stse_polling_save_work,
+				K_SECONDS(CONFIG_STSE_ADAPTIVE_POLLING_SAVE_DELAY));
+	}
+#else
+	ARG_UNUSED(changed);
+#endif
+}
+
+bool stse_polling_delay(void)
+{
+	struct stse_polling *p = NULL;
+	struct stse_polling *it;
+	uint32_t wait_us = 0;
+	k_tid_t self = k_current_get();
+
+	K_SPINLOCK(&stse_polling_lock) {
+		SYS_SLIST_FOR_EACH_CONTAINER(&stse_polling_pending, it, node) {
+			if (it->owner == self) {
+				p = it;
+				break;
+			}
+		}
+		if (p == NULL) {
+			K_SPINLOCK_BREAK;
+		}
+
+		if (p->retries == 0) {
+			uint32_t elapsed = k_cyc_to_us_floor32(k_cycle_get_32() - p->sent_at);
+			uint32_t est = stse_polling_estimate(p);
+
+			wait_us = est > elapsed ? est - elapsed : 0;
+			p->step_us = CONFIG_STSE_ADAPTIVE_POLLING_STEP_US;
+		} else {
+			uint32_t cap = CONFIG_STSE_POLLING_RETRY_INTERVAL * USEC_PER_MSEC;
+
+			wait_us = p->step_us;
+			p->step_us = MIN(p->step_us * 2, cap);
+
+			if (wait_us == cap) {
+				/*
+				 * Backed off: the retries left share what remains of
+				 * the fixed schedule's budget, so that slow commands
+				 * still get as long as they did without the table.
+				 */
+				uint32_t elapsed =
+					k_cyc_to_us_floor32(k_cycle_get_32() - p->sent_at);
+				uint32_t left = CONFIG_STSE_MAX_POLLING_RETRY + 1 - p->retries;
+
+				if (STSE_POLLING_BUDGET_US > elapsed) {
+					wait_us = MAX(wait_us,
+						      (STSE_POLLING_BUDGET_US - elapsed) / left);
+				}
+			}
+		}
+
+		if (++p->retries > CONFIG_STSE_MAX_POLLING_RETRY) {
+			/* STSELib gives up after this delay, stop tracking */
+			sys_slist_find_and_remove(&stse_polling_pending, &p->node);
+			p->pending = false;
+		}
+	}
+
+	if (p == NULL) {
+		return false;
+	}
+	if (wait_us != 0) {
+		k_usleep(wait_us);
+	}
+	return true;
+}
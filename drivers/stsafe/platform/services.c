@@ -4,6 +4,7 @@
  */
 
 #include "stselib.h"
+#include "stse_polling.h"
 
 stse_ReturnCode_t stse_services_platform_init(void)
 {
@@ -14,6 +15,12 @@ stse_ReturnCode_t stse_services_platform_init(void)
 
 void stse_platform_Delay_ms(PLAT_UI16 delay_val)
 {
+#ifdef CONFIG_STSE_ADAPTIVE_POLLING
+	/* Response polling delays follow the learned command timings */
+	if (stse_polling_delay()) {
+		return;
+	}
+#endif
 	k_msleep((PLAT_UI32)delay_val);
 }
 
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2026, CATIE
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/device.h>
+#include <zephyr/kernel.h>
+#include <zephyr/stats/stats.h>
+#include <zephyr/sys/util.h>
+
+#include "../stsafe_priv.h"
+#include "stse_stats.h"
+
+STATS_NAME_START(stsafe_bus)
+STATS_NAME(stsafe_bus, tx_frames)
+STATS_NAME(stsafe_bus, tx_bytes)
+STATS_NAME(stsafe_bus, tx_errors)
+STATS_NAME(stsafe_bus, rx_frames)
+STATS_NAME(stsafe_bus, rx_bytes)
+STATS_NAME(stsafe_bus, nacks)
+STATS_NAME_END(stsafe_bus);
+
+STATS_NAME_START(stsafe_host)
+STATS_NAME(stsafe_host, crc_calls)
+STATS_NAME(stsafe_host, crc_bytes)
+STATS_NAME(stsafe_host, crc_cycles)
+STATS_NAME(stsafe_host, cmac_ops)
+STATS_NAME(stsafe_host, cmac_cycles)
+STATS_NAME_END(stsafe_host);
+
+static STATS_SECT_DECL(stsafe_host) stse_stats_host;
+
+static int stse_stats_host_init(void)
+{
+	return stats_init_and_reg(&stse_stats_host.s_hdr,
+				  STATS_SIZE_INIT_PARMS(stse_stats_host, STATS_SIZE_64),
+				  STATS_NAME_INIT_PARMS(stsafe_host), "stsafe_host");
+}
+
+SYS_INIT(stse_stats_host_init, POST_KERNEL, 0);
+
+void stse_stats_register(struct stse_stats *s, const char *name)
+{
+	/* stse_init() runs again after a failed bring-up */
+	if (s->registered) {
+		return;
+	}
+	stats_init_and_reg(&s->bus.s_hdr, STATS_SIZE_INIT_PARMS(s->bus, STATS_SIZE_32),
+			   STATS_NAME_INIT_PARMS(stsafe_bus), name);
+	s->registered = true;
+}
+
+void stse_stats_cmd_sent(struct stse_stats *s, uint8_t header, uint16_t len)
+{
+	STATS_INC(s->bus, tx_frames);
+	STATS_INCN(s->bus, tx_bytes, len);
+
+	s->inflight = header & STSE_STATS_CMD_MASK;
+	s->sent_at = k_cycle_get_32();
+	s->pending = true;
+}
+
+void stse_stats_tx_error(struct stse_stats *s)
+{
+	STATS_INC(s->bus, tx_errors);
+}
+
+void stse_stats_nack(struct stse_stats *s)
+{
+	STATS_INC(s->bus, nacks);
+	if (s->pending) {
+		s->cmd[s->inflight].polls++;
+	}
+}
+
+void stse_stats_rx(struct stse_stats *s, uint16_t len)
+{
+	/* Every read, length probes included, like rx_bytes */
+	STATS_INC(s->bus, rx_frames);
+	STATS_INCN(s->bus, rx_bytes, len);
+	if (!s->pending) {
+		return;
+	}
+
+	/* First read the chip acknowledged: the command is complete */
+	struct stsafe_cmd_stats *c = &s->cmd[s->inflight];
+	uint32_t us = k_cyc_to_us_floor32(k_cycle_get_32() - s->sent_at);
+	unsigned int bucket = find_msb_set(us / STSAFE_STATS_HIST_BASE_US);
+
+	s->pending = false;
+	c->count++;
+	c->total_us += us;
+	c->max_us = MAX(c->max_us, us);
+	c->hist[MIN(bucket, STSAFE_STATS_HIST_BUCKETS - 1)]++;
+}
+
+void stse_stats_crc(uint32_t start, uint16_t len)
+{
+	STATS_INC(stse_stats_host, crc_calls);
+	STATS_INCN(stse_stats_host, crc_bytes, len);
+	STATS_INCN(stse_stats_host, crc_cycles, k_cycle_get_32() - start);
+}
+
+void stse_stats_cmac(uint32_t start, bool done)
+{
+	STATS_INCN(stse_stats_host, cmac_cycles, k_cycle_get_32() - start);
+	if (done) {
+		STATS_INC(stse_stats_host, cmac_ops);
+	}
+}
+
+int stsafe_cmd_stats_get(const struct device *dev, uint8_t cmd, struct stsafe_cmd_stats *stats)
+{
+	const struct stsafe_config *cfg = dev->config;
+
+	if (cmd >= STSAFE_STATS_CMDS) {
+		return -EINVAL;
+	}
+	*stats = cfg->i2c_ctx->stats.cmd[cmd];
+	return 0;
+}
+
+void stsafe_stats_reset(const struct device *dev)
+{
+	const struct stsafe_config *cfg = dev->config;
+	struct stse_stats *s = &cfg->i2c_ctx->stats;
+
+	memset(s->cmd, 0, sizeof(s->cmd));
+	stats_reset(&s->bus.s_hdr);
+}
@@ -15,6 +15,19 @@
 #define STSE_ITS_ID_KEY_CIPHER ITS_BASE_ADDR + 1
 #define STSE_ITS_ID_KEY_CBC    STSE_ITS_ID_KEY_CIPHER
 #define STSE_ITS_ID_KEY_ECB    STSE_ITS_ID_KEY_CIPHER + 1
+
+/* Persistent keys of a host-key-set devicetree slot, slot 0 uses the IDs above */
+#define STSE_ITS_KEYS_PER_SLOT      3
+#define STSE_ITS_ID_KEY_SLOT(slot)  (ITS_BASE_ADDR + STSE_ITS_KEYS_PER_SLOT * (slot))
+#define STSE_ITS_ID_KEY_CMAC_AT(s)  (STSE_ITS_ID_KEY_SLOT(s))
+#define STSE_ITS_ID_KEY_CBC_AT(s)   (STSE_ITS_ID_KEY_SLOT(s) + 1)
+#define STSE_ITS_ID_KEY_ECB_AT(s)   (STSE_ITS_ID_KEY_SLOT(s) + 2)
+
+/*
+ * ECB key imported next to the cipher key index handed to STSELib, or
+ * PSA_KEY_ID_NULL if that index is not the current cipher key.
+ */
+psa_key_id_t stse_aes_ecb_key(uint32_t cipher_key_idx);
 #endif /* CONFIG_STSE_USE_HOST_SESSION */
 
 #endif /* __STSE_AES_H__ */
@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2026, CATIE
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __STSE_CRC16_H__
+#define __STSE_CRC16_H__
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/slist.h>
+
+PLAT_UI16 crc16_calculate(uint8_t *data, PLAT_UI16 length);
+PLAT_UI16 crc16_update(uint8_t *data, PLAT_UI16 length);
+
+#ifdef CONFIG_STSE_CRC16_FUSED_RX
+/*
+ * Fused receive CRC.
+ *
+ * The platform layer records the CRC of each response fragment while copying
+ * it to the caller (stse_crc16_rx_copy), and the CRC check that STSELib runs
+ * right after over the same fragments is answered from the record. Fragments
+ * up to STSE_CRC16_RX_HEAD bytes are also matched by content.
+ */
+#define STSE_CRC16_RX_HEAD 4
+
+struct stse_crc16_frag {
+	const uint8_t *buf;
+	uint16_t len;
+	uint16_t crc;
+	uint8_t head[STSE_CRC16_RX_HEAD];
+};
+
+struct stse_crc16_rx {
+	sys_snode_t node;
+	k_tid_t owner;
+	uint16_t crc;
+	uint8_t count;
+	uint8_t cursor;
+	bool active;
+	struct stse_crc16_frag frag[CONFIG_STSE_CRC16_FUSED_RX_FRAGMENTS];
+};
+
+void stse_crc16_rx_begin(struct stse_crc16_rx *rx);
+void stse_crc16_rx_copy(struct stse_crc16_rx *rx, uint8_t *dst, const uint8_t *src, uint16_t len);
+#endif /* CONFIG_STSE_CRC16_FUSED_RX */
+
+#endif /* __STSE_CRC16_H__ */
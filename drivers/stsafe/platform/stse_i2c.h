@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2026, CATIE
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __STSE_I2C_H__
+#define __STSE_I2C_H__
+
+#include <zephyr/device.h>
+#include <zephyr/drivers/i2c.h>
+
+#include "stse_crc16.h"
+#include "stse_polling.h"
+#include "stse_trace.h"
+#ifdef CONFIG_STSAFE_STATS
+#include "stse_stats.h"
+#endif
+
+/*
+ * The STSELib platform layer needs a per-instance scratch buffer to assemble
+ * frames before sending them on the wire (and to receive responses). The
+ * largest frame depends on the chip variant:
+ *
+ *   - STSAFE-A110: up to 507 bytes per frame
+ *   - STSAFE-A120: up to 752 bytes per frame
+ *
+ * The buffer is allocated per instance by the driver, sized for the variant
+ * or for the optional max-frame-size devicetree property. With
+ * CONFIG_STSAFE_I2C_ZERO_COPY it only holds the response length probe.
+ */
+#define STSAFE_A110_FRAME_MAX     507U
+#define STSAFE_A120_FRAME_MAX     752U
+#define STSAFE_I2C_SCRATCH_SIZE   16U
+
+/*
+ * Largest frame of the variants in the devicetree, and the device type of an
+ * instance (anything with a device_type field), a constant when the build
+ * only has one variant so that the variant branches fold away.
+ */
+#if defined(CONFIG_STSAFE_A110_ONLY)
+#define STSAFE_VARIANT_FRAME_MAX  STSAFE_A110_FRAME_MAX
+#define STSAFE_DEVICE_TYPE(inst)  STSAFE_A110
+#elif defined(CONFIG_STSAFE_A120_ONLY)
+#define STSAFE_VARIANT_FRAME_MAX  STSAFE_A120_FRAME_MAX
+#define STSAFE_DEVICE_TYPE(inst)  STSAFE_A120
+#else
+#define STSAFE_VARIANT_FRAME_MAX  STSAFE_A120_FRAME_MAX
+#define STSAFE_DEVICE_TYPE(inst)  ((inst)->device_type)
+#endif
+
+struct stsafe_i2c_ctx {
+	const struct device *i2c_bus;
+	uint16_t i2c_addr;
+	uint8_t *buffer;
+	uint16_t buffer_size;
+	uint16_t frame_max;
+	uint16_t frame_size;
+	uint16_t frame_offset;
+	int bus_id;
+	uint8_t device_type;
+#ifdef CONFIG_STSE_USE_HOST_SESSION
+	uint8_t host_key_set;
+#endif
+#ifdef CONFIG_STSE_ADAPTIVE_POLLING
+	struct stse_polling polling;
+#endif
+#ifdef CONFIG_STSAFE_STATS
+	struct stse_stats stats;
+#endif
+#ifdef CONFIG_STSE_CRC16_FUSED_RX
+	struct stse_crc16_rx crc_rx;
+#endif
+#ifdef CONFIG_STSAFE_I2C_ZERO_COPY
+	struct i2c_msg msgs[CONFIG_STSAFE_I2C_MAX_FRAGMENTS];
+	uint8_t num_msgs;
+	bool deferred;
+#endif
+};
+
+/*
+ * Context of the chip the calling thread last sent a command to, or NULL if
+ * it never did. Picks the platform state of a chip, such as its host keys,
+ * in callbacks where STSELib does not pass the busID.
+ */
+struct stsafe_i2c_ctx *stse_i2c_addressed(void);
+
+#endif /* __STSE_I2C_H__ */
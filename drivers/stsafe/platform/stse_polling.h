@@ -0,0 +1,36 @@
+/*
+ * Copyright (c) 2026, CATIE
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __STSE_POLLING_H__
+#define __STSE_POLLING_H__
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/slist.h>
+
+/*
+ * Adaptive response polling.
+ *
+ * The platform layer knows which command header it just sent, but STSELib
+ * only calls stse_platform_Delay_ms() with the fixed polling intervals. The
+ * per-instance state below ties the two together: send_stop records the
+ * command, the delays issued by the same thread until the response arrives
+ * are replaced by a wait on the learned completion time of that command.
+ */
+struct stse_polling {
+	sys_snode_t node;
+	k_tid_t owner;
+	uint32_t sent_at;
+	uint32_t step_us;
+	uint8_t variant;
+	uint8_t cmd;
+	uint8_t retries;
+	bool pending;
+};
+
+void stse_polling_cmd_sent(struct stse_polling *p, uint8_t device_type, uint8_t header);
+void stse_polling_rsp_received(struct stse_polling *p);
+bool stse_polling_delay(void);
+
+#endif /* __STSE_POLLING_H__ */
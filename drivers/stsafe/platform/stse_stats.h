@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2026, CATIE
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __STSE_STATS_H__
+#define __STSE_STATS_H__
+
+#include <zephyr/kernel.h>
+#include <zephyr/stats/stats.h>
+
+#include <drivers/stsafe.h>
+
+/*
+ * Command and bus statistics.
+ *
+ * The platform layer sees every frame go by: send_stop records the command
+ * header, the first successful response read closes its latency. The
+ * rx_frames and rx_bytes counters cover every successful read, the length
+ * probe of a response as well as its body. The bus is held by one thread at
+ * a time, so the per-instance counters are updated without locking. CRC16
+ * and CMAC time is not tied to a bus and is accumulated in a single
+ * "stsafe_host" group.
+ */
+#define STSE_STATS_CMD_MASK 0x1F
+
+STATS_SECT_START(stsafe_bus)
+STATS_SECT_ENTRY32(tx_frames)
+STATS_SECT_ENTRY32(tx_bytes)
+STATS_SECT_ENTRY32(tx_errors)
+STATS_SECT_ENTRY32(rx_frames)
+STATS_SECT_ENTRY32(rx_bytes)
+STATS_SECT_ENTRY32(nacks)
+STATS_SECT_END;
+
+STATS_SECT_START(stsafe_host)
+STATS_SECT_ENTRY64(crc_calls)
+STATS_SECT_ENTRY64(crc_bytes)
+STATS_SECT_ENTRY64(crc_cycles)
+STATS_SECT_ENTRY64(cmac_ops)
+STATS_SECT_ENTRY64(cmac_cycles)
+STATS_SECT_END;
+
+struct stse_stats {
+	STATS_SECT_DECL(stsafe_bus) bus;
+	struct stsafe_cmd_stats cmd[STSAFE_STATS_CMDS];
+	uint32_t sent_at;
+	uint8_t inflight;
+	bool pending;
+	bool registered;
+};
+
+void stse_stats_register(struct stse_stats *s, const char *name);
+void stse_stats_cmd_sent(struct stse_stats *s, uint8_t header, uint16_t len);
+void stse_stats_tx_error(struct stse_stats *s);
+void stse_stats_nack(struct stse_stats *s);
+void stse_stats_rx(struct stse_stats *s, uint16_t len);
+void stse_stats_crc(uint32_t start, uint16_t len);
+void stse_stats_cmac(uint32_t start, bool done);
+
+#endif /* __STSE_STATS_H__ */
@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2026, CATIE
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __STSE_TRACE_H__
+#define __STSE_TRACE_H__
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include <drivers/stsafe.h>
+
+/*
+ * Per-frame debug messages are only built with CONFIG_STSAFE_FRAME_LOG: even
+ * filtered out at run time, a LOG_DBG() on every fragment and CRC update
+ * costs a level check and keeps its format string in the image.
+ */
+#ifdef CONFIG_STSAFE_FRAME_LOG
+#define STSE_FRAME_LOG_DBG(...) LOG_DBG(__VA_ARGS__)
+#else
+#define STSE_FRAME_LOG_DBG(...) do { } while (0)
+#endif
+
+#ifdef CONFIG_STSAFE_FRAME_TRACE
+/*
+ * Record one frame in the trace ring; @p prefix holds the first @p prefix_len
+ * bytes of it. Also emitted as a named tracing event with CONFIG_TRACING.
+ */
+void stse_trace_frame(uint8_t bus_id, enum stsafe_trace_dir dir, uint8_t header, uint16_t len,
+		      const uint8_t *prefix, uint8_t prefix_len);
+#endif
+
+#ifdef CONFIG_STSAFE_CAPTURE
+/*
+ * Append a capture record for a @p len byte frame and return where to copy
+ * the frame, or NULL if the capture is stopped or full.
+ */
+uint8_t *stse_capture_claim(uint8_t bus_id, uint8_t dir, uint16_t len);
+#endif
+
+#endif /* __STSE_TRACE_H__ */
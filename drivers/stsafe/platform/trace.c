@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2026, CATIE
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Binary frame trace.
+ *
+ * One ring of fixed size records shared by all instances, oldest entries
+ * overwritten. Recording a frame is a timestamp and a short copy under a
+ * spinlock, so tracing can stay on in a loaded system without changing its
+ * timing the way logging every frame would.
+ */
+
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+#ifdef CONFIG_TRACING
+#include <zephyr/tracing/tracing.h>
+#endif
+
+#include "stse_trace.h"
+
+static struct stsafe_trace_rec trace_ring[CONFIG_STSAFE_FRAME_TRACE_ENTRIES];
+static struct k_spinlock trace_lock;
+/* Next slot written, and records in the ring */
+static size_t trace_head;
+static size_t trace_count;
+static uint32_t trace_lost;
+
+void stse_trace_frame(uint8_t bus_id, enum stsafe_trace_dir dir, uint8_t header, uint16_t len,
+		      const uint8_t *prefix, uint8_t prefix_len)
+{
+	uint32_t now = k_cycle_get_32();
+
+	prefix_len = MIN(prefix_len, CONFIG_STSAFE_FRAME_TRACE_PAYLOAD);
+
+	K_SPINLOCK(&trace_lock) {
+		struct stsafe_trace_rec *rec = &trace_ring[trace_head];
+
+		rec->cycles = now;
+		rec->bus_id = bus_id;
+		rec->dir = dir;
+		rec->header = header;
+		rec->prefix_len = prefix_len;
+		rec->len = len;
+		if (prefix_len != 0) {
+			memcpy(rec->prefix, prefix, prefix_len);
+		}
+
+		trace_head = (trace_head + 1) % ARRAY_SIZE(trace_ring);
+		if (trace_count < ARRAY_SIZE(trace_ring)) {
+			trace_count++;
+		} else {
+			trace_lost++;
+		}
+	}
+
+#ifdef CONFIG_TRACING
+	sys_trace_named_event("stsafe_frame", (uint32_t)bus_id << 24 | (uint32_t)dir << 16 | len,
+			      header);
+#endif
+}
+
+size_t stsafe_trace_read(struct stsafe_trace_rec *recs, size_t max, uint32_t *lost)
+{
+	size_t n;
+
+	K_SPINLOCK(&trace_lock) {
+		size_t tail = (trace_head + ARRAY_SIZE(trace_ring) - trace_count) %
+			      ARRAY_SIZE(trace_ring);
+
+		n = MIN(max, trace_count);
+		for (size_t i = 0; i < n; i++) {
+			recs[i] = trace_ring[(tail + i) % ARRAY_SIZE(trace_ring)];
+		}
+		trace_count -= n;
+		if (lost != NULL) {
+			*lost = trace_lost;
+		}
+		trace_lost = 0;
+	}
+	return n;
+}
+
+void stsafe_trace_clear(void)
+{
+	K_SPINLOCK(&trace_lock) {
+		trace_count = 0;
+		trace_lost = 0;
+	}
+}
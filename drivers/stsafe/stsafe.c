@@ -10,30 +10,103 @@
 #include <zephyr/drivers/gpio.h>
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
+#include <zephyr/pm/device.h>
+#include <zephyr/pm/device_runtime.h>
 
 #include "stselib.h"
+#include "stsafe_priv.h"
 
 LOG_MODULE_REGISTER(stsafe, CONFIG_STSAFE_LOG_LEVEL);
 
-struct stsafe_config {
-	struct i2c_dt_spec i2c;
-	struct gpio_dt_spec reset_gpio;
-	int bus_id;
-	uint8_t device_type;
-};
-
-struct stsafe_data {
-	stse_Handle_t handle;
-	struct k_mutex lock;
-	bool ready;
-
-	enum stsafe_mode {
-		STSAFE_MODE_UNSET = 0,
-		STSAFE_MODE_SIMPLE,
-		STSAFE_MODE_LOCKED,
-	} mode;
-	struct k_spinlock mode_lock;
-};
+/* Boot time of the chip after the reset pulse */
+#define STSAFE_BOOT_TIME_MS      10
+#define STSAFE_PROBE_INTERVAL_US 500
+
+#define STSAFE_EVT_READY  BIT(0)
+#define STSAFE_EVT_FAILED BIT(1)
+
+#ifdef CONFIG_STSAFE_FRAME_ARENA
+/* Longest wait of a deferred bring-up for a block of the arena */
+#define STSAFE_ARENA_BRINGUP_WAIT_MS 1000
+
+K_MEM_SLAB_DEFINE_STATIC(stsafe_frame_arena, ROUND_UP(STSAFE_VARIANT_FRAME_MAX, 4),
+			 CONFIG_STSAFE_FRAME_ARENA_BLOCKS, 4);
+
+/*
+ * Lend a frame buffer of the arena to @p dev. The caller holds the lock of
+ * the device, or no PM reference to it is outstanding, so calls never race
+ * and nested ones just share the block. Callers serving a user do not wait:
+ * the arena is sized for the expected concurrency, running out is a
+ * configuration error. A deferred bring-up has no user to fail fast for and
+ * may run next to the others, so it waits up to @p wait.
+ */
+static int stsafe_frame_borrow(const struct device *dev, k_timeout_t wait)
+{
+	const struct stsafe_config *cfg = dev->config;
+	struct stsafe_data *data = dev->data;
+	void *block;
+
+	if (data->frame_refs++ > 0) {
+		return 0;
+	}
+	if (k_mem_slab_alloc(&stsafe_frame_arena, &block, wait) != 0) {
+		data->frame_refs--;
+		LOG_ERR("%s: frame arena exhausted, all %d buffers in use "
+			"(raise CONFIG_STSAFE_FRAME_ARENA_BLOCKS)",
+			dev->name, CONFIG_STSAFE_FRAME_ARENA_BLOCKS);
+		return -ENOMEM;
+	}
+	cfg->i2c_ctx->buffer = block;
+	cfg->i2c_ctx->buffer_size = cfg->i2c_ctx->frame_max;
+	return 0;
+}
+
+static void stsafe_frame_return(const struct device *dev)
+{
+	const struct stsafe_config *cfg = dev->config;
+	struct stsafe_data *data = dev->data;
+
+	if (--data->frame_refs > 0) {
+		return;
+	}
+	k_mem_slab_free(&stsafe_frame_arena, cfg->i2c_ctx->buffer);
+	cfg->i2c_ctx->buffer = NULL;
+	cfg->i2c_ctx->buffer_size = 0;
+}
+#endif /* CONFIG_STSAFE_FRAME_ARENA */
+
+/*
+ * Wait for the chip to boot after a reset pulse or a wake-up. It does not
+ * acknowledge its address until then: with CONFIG_STSAFE_RESET_PROBE, probe
+ * it with empty writes instead of always sleeping the worst case.
+ * Controllers that reject empty writes fall back to the full delay.
+ */
+static void stsafe_wait_boot(const struct device *dev)
+{
+#ifdef CONFIG_STSAFE_RESET_PROBE
+	const struct stsafe_config *cfg = dev->config;
+	k_timepoint_t end = sys_timepoint_calc(K_MSEC(STSAFE_BOOT_TIME_MS));
+	uint8_t dummy = 0;
+
+	do {
+		int ret = i2c_write_dt(&cfg->i2c, &dummy, 0);
+
+		if (ret == 0) {
+			LOG_DBG("%s: acknowledged after boot", dev->name);
+			return;
+		}
+		if (ret != -EIO) {
+			break;
+		}
+		k_usleep(STSAFE_PROBE_INTERVAL_US);
+	} while (!sys_timepoint_expired(end));
+
+	k_sleep(sys_timepoint_timeout(end));
+#else
+	ARG_UNUSED(dev);
+	k_msleep(STSAFE_BOOT_TIME_MS);
+#endif
+}
 
 static int stsafe_reset(const struct device *dev)
 {
@@ -47,13 +120,53 @@ static int stsafe_reset(const struct device *dev)
 	gpio_pin_set_dt(&cfg->reset_gpio, 1);
 	k_msleep(1);
 	gpio_pin_set_dt(&cfg->reset_gpio, 0);
-	k_msleep(10);
+	stsafe_wait_boot(dev);
 
 	LOG_DBG("%s: reset complete", dev->name);
 	return 0;
 }
 
-static bool stsafe_claim_mode(struct stsafe_data *data, enum stsafe_mode target)
+#ifdef CONFIG_STSAFE_PM
+static int stsafe_pm_action(const struct device *dev, enum pm_device_action action)
+{
+	const struct stsafe_config *cfg = dev->config;
+	struct stsafe_data *data = dev->data;
+	stse_ReturnCode_t rc;
+	uint8_t dummy = 0;
+
+	switch (action) {
+	case PM_DEVICE_ACTION_SUSPEND:
+#ifdef CONFIG_STSAFE_FRAME_ARENA
+		/* Left awake when busy, the next autosuspend tries again */
+		if (stsafe_frame_borrow(dev, K_NO_WAIT) != 0) {
+			return -EBUSY;
+		}
+#endif
+		/* Every bus user holds a reference: nothing else is talking to the chip */
+		rc = stse_device_enter_hibernate(&data->handle,
+						 STSAFEA_HIBERNATE_WAKEUP_I2C_OR_RESET);
+#ifdef CONFIG_STSAFE_FRAME_ARENA
+		stsafe_frame_return(dev);
+#endif
+		if (rc != STSE_OK) {
+			LOG_ERR("%s: hibernate failed: 0x%x", dev->name, rc);
+			return -EIO;
+		}
+		LOG_DBG("%s: hibernating", dev->name);
+		return 0;
+	case PM_DEVICE_ACTION_RESUME:
+		/* Address match wakes the chip up; the write itself is NACKed */
+		(void)i2c_write_dt(&cfg->i2c, &dummy, 0);
+		stsafe_wait_boot(dev);
+		LOG_DBG("%s: awake", dev->name);
+		return 0;
+	default:
+		return -ENOTSUP;
+	}
+}
+#endif /* CONFIG_STSAFE_PM */
+
+bool stsafe_claim_mode(struct stsafe_data *data, enum stsafe_mode target)
 {
 	bool ok = false;
 
@@ -66,6 +179,27 @@ static bool stsafe_claim_mode(struct stsafe_data *data, enum stsafe_mode target)
 	return ok;
 }
 
+int stsafe_wait_ready(const struct device *dev, k_timeout_t timeout)
+{
+	struct stsafe_data *data = dev->data;
+
+	if (data->ready) {
+		return 0;
+	}
+#ifdef CONFIG_STSAFE_DEFERRED_INIT
+	uint32_t evt = k_event_wait(&data->init_evt, STSAFE_EVT_READY | STSAFE_EVT_FAILED, false,
+				    timeout);
+
+	if (evt & STSAFE_EVT_READY) {
+		return 0;
+	}
+	return evt == 0 ? -EAGAIN : -ENODEV;
+#else
+	ARG_UNUSED(timeout);
+	return -ENODEV;
+#endif
+}
+
 stse_Handle_t *stsafe_get_handle(const struct device *dev)
 {
 	struct stsafe_data *data = dev->data;
@@ -80,14 +214,55 @@ stse_Handle_t *stsafe_get_handle(const struct device *dev)
 			dev->name);
 		return NULL;
 	}
+#ifdef CONFIG_STSAFE_FRAME_ARENA
+	/* Simple mode has no release either: the buffer stays borrowed */
+	if (data->frame_refs == 0 && stsafe_frame_borrow(dev, K_NO_WAIT) != 0) {
+		return NULL;
+	}
+#endif
+#ifdef CONFIG_STSAFE_PM
+	/* Simple mode has no release to suspend on: keep the chip awake for good */
+	if (!data->pm_pinned) {
+		data->pm_pinned = true;
+		(void)pm_device_runtime_get(dev);
+	}
+#endif
 	return &data->handle;
 }
 
-stse_Handle_t *stsafe_acquire(const struct device *dev, k_timeout_t timeout)
+static int stsafe_lock(const struct device *dev, int prio, k_timepoint_t end, bool admit)
 {
+#ifdef CONFIG_STSAFE_ARBITER
+	return stsafe_arb_lock(dev, prio, end, admit);
+#else
 	struct stsafe_data *data = dev->data;
-	if (!data->ready) {
-		LOG_ERR("%s: acquire called on uninitialized device", dev->name);
+
+	ARG_UNUSED(prio);
+	ARG_UNUSED(admit);
+	return k_mutex_lock(&data->lock, sys_timepoint_timeout(end));
+#endif
+}
+
+static void stsafe_unlock(const struct device *dev)
+{
+#ifdef CONFIG_STSAFE_ARBITER
+	stsafe_arb_unlock(dev);
+#else
+	struct stsafe_data *data = dev->data;
+
+	k_mutex_unlock(&data->lock);
+#endif
+}
+
+static stse_Handle_t *stsafe_acquire_common(const struct device *dev, int prio,
+					    k_timepoint_t end, bool admit)
+{
+	struct stsafe_data *data = dev->data;
+	int ret = stsafe_wait_ready(dev, sys_timepoint_timeout(end));
+
+	if (ret != 0) {
+		LOG_ERR("%s: acquire called on %s device", dev->name,
+			ret == -EAGAIN ? "initializing" : "uninitialized");
 		return NULL;
 	}
 
@@ -98,37 +273,114 @@ stse_Handle_t *stsafe_acquire(const struct device *dev, k_timeout_t timeout)
 		return NULL;
 	}
 
-	if (k_mutex_lock(&data->lock, timeout) != 0) {
+#ifdef CONFIG_STSAFE_LOCK_PROFILE
+	uint32_t start = k_cycle_get_32();
+#endif
+	ret = stsafe_lock(dev, prio, end, admit);
+#ifdef CONFIG_STSAFE_LOCK_PROFILE
+	stsafe_lock_profile_acquired(dev, start, ret == 0);
+#endif
+	if (ret == -ETIME) {
+		return NULL;
+	}
+	if (ret != 0) {
 		LOG_ERR("%s: acquire timed out", dev->name);
 		return NULL;
 	}
+#ifdef CONFIG_STSAFE_PM
+	/* Cancels a pending autosuspend, so a burst of commands wakes the chip once */
+	ret = pm_device_runtime_get(dev);
+	if (ret != 0) {
+		LOG_ERR("%s: wake-up failed: %d", dev->name, ret);
+#ifdef CONFIG_STSAFE_LOCK_PROFILE
+		stsafe_lock_profile_release(dev);
+#endif
+		stsafe_unlock(dev);
+		return NULL;
+	}
+#endif
+#ifdef CONFIG_STSAFE_FRAME_ARENA
+	/* After the wake-up: a pending autosuspend may use the block until then */
+	if (stsafe_frame_borrow(dev, K_NO_WAIT) != 0) {
+#ifdef CONFIG_STSAFE_PM
+		(void)pm_device_runtime_put_async(dev, K_MSEC(CONFIG_STSAFE_PM_AUTOSUSPEND_MS));
+#endif
+#ifdef CONFIG_STSAFE_LOCK_PROFILE
+		stsafe_lock_profile_release(dev);
+#endif
+		stsafe_unlock(dev);
+		return NULL;
+	}
+#endif
 	LOG_DBG("%s: acquired", dev->name);
 	return &data->handle;
 }
 
+stse_Handle_t *stsafe_acquire(const struct device *dev, k_timeout_t timeout)
+{
+	return stsafe_acquire_common(dev, k_thread_priority_get(k_current_get()),
+				     sys_timepoint_calc(timeout), false);
+}
+
+#ifdef CONFIG_STSAFE_ARBITER
+stse_Handle_t *stsafe_acquire_deadline(const struct device *dev, int prio, k_timeout_t deadline)
+{
+	return stsafe_acquire_common(dev, prio, sys_timepoint_calc(deadline), true);
+}
+#endif
+
 void stsafe_release(const struct device *dev)
 {
-	struct stsafe_data *data = dev->data;
-	k_mutex_unlock(&data->lock);
+#ifdef CONFIG_STSAFE_FRAME_ARENA
+	stsafe_frame_return(dev);
+#endif
+#ifdef CONFIG_STSAFE_PM
+	(void)pm_device_runtime_put_async(dev, K_MSEC(CONFIG_STSAFE_PM_AUTOSUSPEND_MS));
+#endif
+#ifdef CONFIG_STSAFE_LOCK_PROFILE
+	stsafe_lock_profile_release(dev);
+#endif
+	stsafe_unlock(dev);
 	LOG_DBG("%s: released", dev->name);
 }
 
-static int stsafe_init(const struct device *dev)
+int stsafe_transact(const struct device *dev, struct stsafe_txn_op *ops, size_t num_ops,
+		    uint32_t flags, k_timeout_t timeout)
 {
-	const struct stsafe_config *cfg = dev->config;
-	struct stsafe_data *data = dev->data;
+	size_t i;
 
-	if (!device_is_ready(cfg->i2c.bus)) {
-		LOG_ERR("%s: I2C bus '%s' not ready", dev->name, cfg->i2c.bus->name);
-		return -ENODEV;
+	for (i = 0; i < num_ops; i++) {
+		if (ops[i].fn == NULL) {
+			return -EINVAL;
+		}
 	}
-	if (!gpio_is_ready_dt(&cfg->reset_gpio)) {
-		LOG_ERR("%s: reset GPIO port '%s' not ready", dev->name,
-			cfg->reset_gpio.port->name);
-		return -ENODEV;
+
+	stse_Handle_t *handle = stsafe_acquire(dev, timeout);
+
+	if (handle == NULL) {
+		return -EBUSY;
 	}
 
-	k_mutex_init(&data->lock);
+	for (i = 0; i < num_ops; i++) {
+		ops[i].result = ops[i].fn(handle, ops[i].user_data);
+		if (ops[i].result != STSE_OK) {
+			LOG_DBG("%s: transaction op %zu failed: 0x%x", dev->name, i, ops[i].result);
+			if (flags & STSAFE_TXN_STOP_ON_ERROR) {
+				i++;
+				break;
+			}
+		}
+	}
+
+	stsafe_release(dev);
+	return i;
+}
+
+/* Reset and STSELib handshake: the slow part of the bring-up */
+static int stsafe_bringup(const struct device *dev)
+{
+	const struct stsafe_config *cfg = dev->config;
+	struct stsafe_data *data = dev->data;
 
 	stsafe_reset(dev);
 
@@ -139,39 +391,172 @@ static int stsafe_init(const struct device *dev)
 	}
 
 	data->handle.io.busID = cfg->bus_id;
-	data->handle.device_type = cfg->device_type;
+	data->handle.device_type = STSAFE_DEVICE_TYPE(cfg);
 
+#ifdef CONFIG_STSAFE_FRAME_ARENA
+	/* At boot the instances come up one after the other: a block is always free */
+	if (stsafe_frame_borrow(dev, IS_ENABLED(CONFIG_STSAFE_DEFERRED_INIT)
+					     ? K_MSEC(STSAFE_ARENA_BRINGUP_WAIT_MS)
+					     : K_NO_WAIT) != 0) {
+		return -ENOMEM;
+	}
+#endif
 	rc = stse_init(&data->handle, (void *)dev);
+#ifdef CONFIG_STSAFE_FRAME_ARENA
+	stsafe_frame_return(dev);
+#endif
 	if (rc != STSE_OK) {
 		LOG_ERR("%s: stse_init failed: 0x%x", dev->name, rc);
 		return -EIO;
 	}
 
+#ifdef CONFIG_STSAFE_PM
+	/* Before ready: users only show up once the chip can be woken on demand */
+	int ret = pm_device_runtime_enable(dev);
+	if (ret != 0) {
+		LOG_WRN("%s: runtime PM not enabled: %d", dev->name, ret);
+	}
+#endif
+
 	data->ready = true;
+
+#ifdef CONFIG_STSAFE_ENTROPY
+	stsafe_entropy_init(dev);
+#endif
+
 	LOG_INF("%s: ready (A1%s @ 0x%02x, bus_id=%d)", dev->name,
-		cfg->device_type == STSAFE_A110 ? "10" : "20", cfg->i2c.addr, cfg->bus_id);
+		STSAFE_DEVICE_TYPE(cfg) == STSAFE_A110 ? "10" : "20", cfg->i2c.addr, cfg->bus_id);
 	return 0;
 }
 
-#define GET_STSAFE_TYPE(inst)                                                                      \
-	COND_CODE_1(DT_INST_NODE_HAS_COMPAT(inst, st_stsafe_a110), (STSAFE_A110), (STSAFE_A120))
+#ifdef CONFIG_STSAFE_DEFERRED_INIT
+static void stsafe_init_work_handler(struct k_work *work)
+{
+	struct stsafe_data *data = CONTAINER_OF(work, struct stsafe_data, init_work);
+
+	int ret = stsafe_bringup(data->dev);
+
+	k_event_post(&data->init_evt, ret == 0 ? STSAFE_EVT_READY : STSAFE_EVT_FAILED);
+}
+#endif
+
+static int stsafe_init(const struct device *dev)
+{
+	const struct stsafe_config *cfg = dev->config;
+	struct stsafe_data *data = dev->data;
+
+	if (!device_is_ready(cfg->i2c.bus)) {
+		LOG_ERR("%s: I2C bus '%s' not ready", dev->name, cfg->i2c.bus->name);
+		return -ENODEV;
+	}
+	if (!gpio_is_ready_dt(&cfg->reset_gpio)) {
+		LOG_ERR("%s: reset GPIO port '%s' not ready", dev->name,
+			cfg->reset_gpio.port->name);
+		return -ENODEV;
+	}
 
-#define STSAFE_INIT(inst)                                                                          \
-	static struct stsafe_data stsafe_data_##inst;                                              \
-	static const struct stsafe_config stsafe_cfg_##inst = {                                    \
+	data->dev = dev;
+#ifdef CONFIG_STSAFE_ARBITER
+	stsafe_arb_init(dev);
+#else
+	k_mutex_init(&data->lock);
+#endif
+#ifdef CONFIG_STSAFE_ZONE_CACHE
+	stsafe_cache_init(dev);
+#endif
+
+#ifdef CONFIG_STSAFE_ASYNC
+	int ret = stsafe_async_init(dev);
+	if (ret != 0) {
+		return ret;
+	}
+#endif
+
+#ifdef CONFIG_STSAFE_DEFERRED_INIT
+	/* Instances come up in parallel, each on its own STSAFE work queue */
+	k_event_init(&data->init_evt);
+	k_work_init(&data->init_work, stsafe_init_work_handler);
+	k_work_submit_to_queue(&data->async_q, &data->init_work);
+	return 0;
+#else
+	return stsafe_bringup(dev);
+#endif
+}
+
+#ifdef CONFIG_STSAFE_I2C_ZERO_COPY
+#define STSAFE_BUFFER_SIZE(frame_max) STSAFE_I2C_SCRATCH_SIZE
+#else
+#define STSAFE_BUFFER_SIZE(frame_max) (frame_max)
+#endif
+
+/* With the frame arena, the buffer is only set while the device is held */
+#define STSAFE_BUFFER_DEFINE(name, frame_max)                                                      \
+	IF_DISABLED(CONFIG_STSAFE_FRAME_ARENA,                                                     \
+		    (static uint8_t stsafe_buf_##name[STSAFE_BUFFER_SIZE(frame_max)];))
+
+#define STSAFE_BUFFER_CFG(name)                                                                    \
+	IF_DISABLED(CONFIG_STSAFE_FRAME_ARENA,                                                     \
+		    (.buffer = stsafe_buf_##name,                                                  \
+		     .buffer_size = sizeof(stsafe_buf_##name),))
+
+#define STSAFE_ASYNC_STACK_DEFINE(name)                                                            \
+	IF_ENABLED(CONFIG_STSAFE_ASYNC,                                                            \
+		   (K_THREAD_STACK_DEFINE(stsafe_async_stack_##name,                               \
+					  CONFIG_STSAFE_ASYNC_STACK_SIZE);))
+
+#define STSAFE_ASYNC_CFG(name)                                                                     \
+	IF_ENABLED(CONFIG_STSAFE_ASYNC,                                                            \
+		   (.async_stack = stsafe_async_stack_##name,                                      \
+		    .async_stack_size = K_THREAD_STACK_SIZEOF(stsafe_async_stack_##name),))
+
+#define STSAFE_CACHE_CFG(inst)                                                                     \
+	IF_ENABLED(CONFIG_STSAFE_ZONE_CACHE,                                                       \
+		   (.cache_zones = COND_CODE_1(DT_INST_NODE_HAS_PROP(inst, cache_zones),           \
+					       ((const uint8_t[])DT_INST_PROP(inst, cache_zones)), \
+					       (NULL)),                                            \
+		    .num_cache_zones = DT_INST_PROP_LEN_OR(inst, cache_zones, 0),))
+
+#define STSAFE_PM_GET(inst) COND_CODE_1(CONFIG_STSAFE_PM, (PM_DEVICE_DT_INST_GET(inst)), (NULL))
+
+#define STSAFE_INIT(inst, name, type, bus_base, variant_frame_max)                                 \
+	STSAFE_ASYNC_STACK_DEFINE(name)                                                            \
+	STSAFE_BUFFER_DEFINE(name, DT_INST_PROP_OR(inst, max_frame_size, variant_frame_max))      \
+	static struct stsafe_i2c_ctx stsafe_i2c_ctx_##name = {                                     \
+		STSAFE_BUFFER_CFG(name)                                                            \
+		.frame_max = DT_INST_PROP_OR(inst, max_frame_size, variant_frame_max),             \
+		IF_ENABLED(CONFIG_STSE_USE_HOST_SESSION,                                           \
+			   (.host_key_set = DT_INST_PROP(inst, host_key_set),))                    \
+	};                                                                                         \
+	static struct stsafe_data stsafe_data_##name;                                              \
+	IF_ENABLED(CONFIG_STSAFE_PM, (PM_DEVICE_DT_INST_DEFINE(inst, stsafe_pm_action);))          \
+	static const struct stsafe_config stsafe_cfg_##name = {                                    \
 		.i2c = I2C_DT_SPEC_INST_GET(inst),                                                 \
 		.reset_gpio = GPIO_DT_SPEC_INST_GET(inst, reset_gpios),                            \
-		.bus_id = inst,                                                                    \
-		.device_type = GET_STSAFE_TYPE(inst),                                              \
+		.i2c_ctx = &stsafe_i2c_ctx_##name,                                                 \
+		.bus_id = (bus_base) + inst,                                                       \
+		.device_type = type,                                                               \
+		STSAFE_ASYNC_CFG(name)                                                             \
+		STSAFE_CACHE_CFG(inst)                                                             \
 	};                                                                                         \
-	DEVICE_DT_INST_DEFINE(inst, stsafe_init, NULL, &stsafe_data_##inst, &stsafe_cfg_##inst,    \
-			      POST_KERNEL, CONFIG_STSAFE_INIT_PRIORITY, NULL);
+	BUILD_ASSERT(DT_INST_PROP_OR(inst, max_frame_size, variant_frame_max) <=                   \
+			     variant_frame_max,                                                    \
+		     "max-frame-size larger than the variant maximum");                            \
+	BUILD_ASSERT(DT_INST_PROP(inst, host_key_set) < STSAFE_HOST_KEY_SETS,                      \
+		     "host-key-set out of range");                                                 \
+	DEVICE_DT_INST_DEFINE(inst, stsafe_init, STSAFE_PM_GET(inst), &stsafe_data_##name,         \
+			      &stsafe_cfg_##name, POST_KERNEL, CONFIG_STSAFE_INIT_PRIORITY,        \
+			      STSAFE_DEVICE_API);
+
+#define STSAFE_INIT_A120(inst) STSAFE_INIT(inst, a120_##inst, STSAFE_A120, 0, STSAFE_A120_FRAME_MAX)
+#define STSAFE_INIT_A110(inst)                                                                     \
+	STSAFE_INIT(inst, a110_##inst, STSAFE_A110, DT_NUM_INST_STATUS_OKAY(st_stsafe_a120),      \
+		    STSAFE_A110_FRAME_MAX)
 
 #undef DT_DRV_COMPAT
 #define DT_DRV_COMPAT st_stsafe_a120
-DT_INST_FOREACH_STATUS_OKAY(STSAFE_INIT)
+DT_INST_FOREACH_STATUS_OKAY(STSAFE_INIT_A120)
 #undef DT_DRV_COMPAT
 
 #define DT_DRV_COMPAT st_stsafe_a110
-DT_INST_FOREACH_STATUS_OKAY(STSAFE_INIT)
+DT_INST_FOREACH_STATUS_OKAY(STSAFE_INIT_A110)
 #undef DT_DRV_COMPAT
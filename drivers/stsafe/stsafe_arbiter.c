@@ -0,0 +1,254 @@
+/*
+ * Copyright (c) 2026, CATIE
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Device arbitration by priority and deadline.
+ *
+ * Replaces the per-instance mutex when CONFIG_STSAFE_ARBITER is enabled.
+ * Waiters are granted the device in order of request priority (Zephyr
+ * thread priority scale, lower is more urgent), then of deadline, then of
+ * arrival. Like the mutex it is recursive and lends the thread priority of
+ * the most urgent waiting thread to the holder, whatever the request
+ * priorities. The average hold time is tracked so
+ * that stsafe_acquire_deadline() can turn down requests that would not get
+ * the device before their deadline.
+ */
+
+#include <zephyr/device.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/dlist.h>
+
+#include "stsafe_priv.h"
+
+LOG_MODULE_DECLARE(stsafe, CONFIG_STSAFE_LOG_LEVEL);
+
+/* Weight of a new sample in the hold time average (log2) */
+#define STSAFE_ARB_HOLD_AVG_SHIFT 3
+
+struct stsafe_arb_waiter {
+	sys_dnode_t node;
+	struct k_sem sem;
+	k_tid_t thread;
+	int thread_prio;
+	int prio;
+	k_timepoint_t deadline;
+	bool granted;
+};
+
+static bool stsafe_arb_before(int prio_a, k_timepoint_t deadline_a, int prio_b,
+			      k_timepoint_t deadline_b)
+{
+	if (prio_a != prio_b) {
+		return prio_a < prio_b;
+	}
+	return sys_timepoint_cmp(deadline_a, deadline_b) < 0;
+}
+
+static void stsafe_arb_grant(struct stsafe_arbiter *arb, k_tid_t thread, int prio,
+			     k_timepoint_t deadline)
+{
+	arb->owner = thread;
+	arb->depth = 1;
+	arb->owner_prio = prio;
+	arb->owner_base_prio = k_thread_priority_get(thread);
+	arb->owner_deadline = deadline;
+	arb->granted_at = k_uptime_ticks();
+}
+
+/*
+ * Priority inheritance, as with k_mutex: the holder runs at the priority of
+ * the most urgent waiting thread, or its own when that is more urgent. The
+ * request priority is not lent, as it is an arbitrary caller value.
+ */
+static void stsafe_arb_boost(struct stsafe_arbiter *arb)
+{
+	struct stsafe_arb_waiter *w;
+	int prio = arb->owner_base_prio;
+
+	SYS_DLIST_FOR_EACH_CONTAINER(&arb->waiters, w, node) {
+		prio = MIN(prio, w->thread_prio);
+	}
+	if (k_thread_priority_get(arb->owner) != prio) {
+		k_thread_priority_set(arb->owner, prio);
+	}
+}
+
+/* Time until a request of this priority and deadline would get the device */
+static uint32_t stsafe_arb_wait_estimate(struct stsafe_arbiter *arb, int prio,
+					 k_timepoint_t deadline)
+{
+	struct stsafe_arb_waiter *w;
+	uint32_t ahead = 1;
+
+	SYS_DLIST_FOR_EACH_CONTAINER(&arb->waiters, w, node) {
+		if (!stsafe_arb_before(prio, deadline, w->prio, w->deadline)) {
+			ahead++;
+		}
+	}
+	return ahead * arb->hold_avg_ticks;
+}
+
+int stsafe_arb_lock(const struct device *dev, int prio, k_timepoint_t end, bool admit)
+{
+	struct stsafe_data *data = dev->data;
+	struct stsafe_arbiter *arb = &data->arb;
+	struct stsafe_arb_waiter w = {
+		.thread = k_current_get(),
+		.thread_prio = k_thread_priority_get(k_current_get()),
+		.prio = prio,
+		.deadline = end,
+	};
+	k_spinlock_key_t key = k_spin_lock(&arb->lock);
+
+	if (arb->owner == NULL) {
+		stsafe_arb_grant(arb, w.thread, prio, end);
+		k_spin_unlock(&arb->lock, key);
+		return 0;
+	}
+	if (arb->owner == w.thread) {
+		arb->depth++;
+		k_spin_unlock(&arb->lock, key);
+		return 0;
+	}
+	if (sys_timepoint_expired(end)) {
+		k_spin_unlock(&arb->lock, key);
+		return -EBUSY;
+	}
+	if (admit && !K_TIMEOUT_EQ(sys_timepoint_timeout(end), K_FOREVER) &&
+	    stsafe_arb_wait_estimate(arb, prio, end) > sys_timepoint_timeout(end).ticks) {
+		k_spin_unlock(&arb->lock, key);
+		LOG_DBG("%s: deadline cannot be met", dev->name);
+		return -ETIME;
+	}
+
+	/* Sorted insert, after the waiters of the same rank */
+	struct stsafe_arb_waiter *pos;
+
+	k_sem_init(&w.sem, 0, 1);
+	SYS_DLIST_FOR_EACH_CONTAINER(&arb->waiters, pos, node) {
+		if (stsafe_arb_before(prio, end, pos->prio, pos->deadline)) {
+			sys_dlist_insert(&pos->node, &w.node);
+			break;
+		}
+	}
+	if (!sys_dnode_is_linked(&w.node)) {
+		sys_dlist_append(&arb->waiters, &w.node);
+	}
+
+	stsafe_arb_boost(arb);
+	k_spin_unlock(&arb->lock, key);
+
+	int ret = k_sem_take(&w.sem, sys_timepoint_timeout(end));
+
+	if (ret != 0) {
+		key = k_spin_lock(&arb->lock);
+		if (!w.granted) {
+			sys_dlist_remove(&w.node);
+			/* Only the remaining waiters still lend their priority */
+			stsafe_arb_boost(arb);
+		}
+		k_spin_unlock(&arb->lock, key);
+
+		if (!w.granted) {
+			return -EAGAIN;
+		}
+		/* Granted while timing out: the grant is ours, wait for its signal */
+		k_sem_take(&w.sem, K_FOREVER);
+	}
+	return 0;
+}
+
+void stsafe_arb_unlock(const struct device *dev)
+{
+	struct stsafe_data *data = dev->data;
+	struct stsafe_arbiter *arb = &data->arb;
+	struct stsafe_arb_waiter *next = NULL;
+	k_spinlock_key_t key = k_spin_lock(&arb->lock);
+
+	if (arb->owner != k_current_get()) {
+		k_spin_unlock(&arb->lock, key);
+		LOG_ERR("%s: released by a thread not holding it", dev->name);
+		return;
+	}
+	if (--arb->depth > 0) {
+		k_spin_unlock(&arb->lock, key);
+		return;
+	}
+
+	int32_t held = (int32_t)(k_uptime_ticks() - arb->granted_at);
+
+	arb->hold_avg_ticks += (held - (int32_t)arb->hold_avg_ticks) >> STSAFE_ARB_HOLD_AVG_SHIFT;
+
+	if (k_thread_priority_get(arb->owner) != arb->owner_base_prio) {
+		k_thread_priority_set(arb->owner, arb->owner_base_prio);
+	}
+
+	sys_dnode_t *node = sys_dlist_get(&arb->waiters);
+
+	if (node != NULL) {
+		next = CONTAINER_OF(node, struct stsafe_arb_waiter, node);
+		next->granted = true;
+		stsafe_arb_grant(arb, next->thread, next->prio, next->deadline);
+		stsafe_arb_boost(arb);
+	} else {
+		arb->owner = NULL;
+	}
+	k_spin_unlock(&arb->lock, key);
+
+	/* Outside the lock so that the waiter runs right away if it is more urgent */
+	if (next != NULL) {
+		k_sem_give(&next->sem);
+	}
+}
+
+int stsafe_yield(const struct device *dev)
+{
+	struct stsafe_data *data = dev->data;
+	struct stsafe_arbiter *arb = &data->arb;
+	bool yield = false;
+	int ret = 0;
+	int prio;
+
+	K_SPINLOCK(&arb->lock) {
+		if (arb->owner != k_current_get()) {
+			ret = -EPERM;
+			K_SPINLOCK_BREAK;
+		}
+		if (arb->depth != 1) {
+			K_SPINLOCK_BREAK;
+		}
+
+		struct stsafe_arb_waiter *first =
+			SYS_DLIST_PEEK_HEAD_CONTAINER(&arb->waiters, first, node);
+
+		prio = arb->owner_prio;
+		yield = first != NULL && stsafe_arb_before(first->prio, first->deadline, prio,
+							    arb->owner_deadline);
+	}
+
+	if (!yield) {
+		return ret;
+	}
+
+	/* Back in line behind the urgent work, with no deadline left to miss */
+	LOG_DBG("%s: yielding", dev->name);
+#ifdef CONFIG_STSAFE_LOCK_PROFILE
+	/* Two holds with a wait in between, as if released and acquired again */
+	stsafe_lock_profile_release(dev);
+	uint32_t start = k_cycle_get_32();
+#endif
+	stsafe_arb_unlock(dev);
+	ret = stsafe_arb_lock(dev, prio, sys_timepoint_calc(K_FOREVER), false);
+#ifdef CONFIG_STSAFE_LOCK_PROFILE
+	stsafe_lock_profile_acquired(dev, start, ret == 0);
+#endif
+	return ret;
+}
+
+void stsafe_arb_init(const struct device *dev)
+{
+	struct stsafe_data *data = dev->data;
+
+	sys_dlist_init(&data->arb.waiters);
+}
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2026, CATIE
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Asynchronous command submission.
+ *
+ * Every instance owns a bounded queue of operations and a dedicated work
+ * queue thread that drains it through the locked API, so callers don't
+ * park their own stack on the device mutex or in the response polling
+ * delays while the secure element computes.
+ */
+
+#include <zephyr/device.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include "stsafe_priv.h"
+
+LOG_MODULE_DECLARE(stsafe, CONFIG_STSAFE_LOG_LEVEL);
+
+#ifdef CONFIG_STSAFE_ASYNC_ZBUS
+ZBUS_CHAN_DEFINE(stsafe_async_chan, struct stsafe_async_event, NULL, NULL, ZBUS_OBSERVERS_EMPTY,
+		 ZBUS_MSG_INIT(0));
+#endif
+
+/*
+ * Notifications are delivered in order: zbus, callback, signal. The event
+ * carries the result by value and is published before the callback, which
+ * may free or reuse the descriptor. The signal is raised last from local
+ * copies, so a caller waiting on it may release the descriptor as soon as it
+ * fires.
+ */
+static void stsafe_async_complete(const struct device *dev, struct stsafe_async_op *op)
+{
+	struct k_poll_signal *signal = op->signal;
+	stse_ReturnCode_t result = op->result;
+
+#ifdef CONFIG_STSAFE_ASYNC_ZBUS
+	struct stsafe_async_event evt = {
+		.dev = dev,
+		.op = op,
+		.user_data = op->user_data,
+		.result = result,
+	};
+
+	if (zbus_chan_pub(&stsafe_async_chan, &evt, K_NO_WAIT) != 0) {
+		LOG_WRN("%s: could not publish async completion", dev->name);
+	}
+#endif
+
+	if (op->cb != NULL) {
+		op->cb(dev, op);
+	}
+
+	if (signal != NULL) {
+		k_poll_signal_raise(signal, result);
+	}
+}
+
+static void stsafe_async_work_handler(struct k_work *work)
+{
+	struct stsafe_data *data = CONTAINER_OF(work, struct stsafe_data, async_work);
+	const struct device *dev = data->dev;
+	struct stsafe_async_op *op;
+
+	while (k_msgq_get(&data->async_msgq, &op, K_NO_WAIT) == 0) {
+		stse_Handle_t *handle = stsafe_acquire(dev, K_FOREVER);
+
+		if (handle == NULL) {
+			op->result = STSE_CORE_INVALID_PARAMETER;
+		} else {
+			op->result = op->fn(handle, op->user_data);
+			stsafe_release(dev);
+		}
+
+		LOG_DBG("%s: async op %p done: 0x%x", dev->name, (void *)op, op->result);
+#ifdef CONFIG_STSAFE_POOL
+		if (op->pool != NULL && stsafe_pool_async_done(dev, op)) {
+			continue;
+		}
+#endif
+		stsafe_async_complete(dev, op);
+	}
+}
+
+int stsafe_async_enqueue(const struct device *dev, struct stsafe_async_op *op)
+{
+	struct stsafe_data *data = dev->data;
+
+	/* Operations queued during a deferred initialization wait for it */
+	if (stsafe_wait_ready(dev, K_NO_WAIT) == -ENODEV) {
+		LOG_ERR("%s: submit called on uninitialized device", dev->name);
+		return -ENODEV;
+	}
+	if (!stsafe_claim_mode(data, STSAFE_MODE_LOCKED)) {
+		LOG_ERR("%s: submit called on device already in simple mode", dev->name);
+		return -EPERM;
+	}
+
+	if (k_msgq_put(&data->async_msgq, &op, K_NO_WAIT) != 0) {
+		LOG_WRN("%s: async queue full", dev->name);
+		return -EAGAIN;
+	}
+
+	k_work_submit_to_queue(&data->async_q, &data->async_work);
+	return 0;
+}
+
+int stsafe_submit(const struct device *dev, struct stsafe_async_op *op)
+{
+	if (op == NULL || op->fn == NULL) {
+		return -EINVAL;
+	}
+#ifdef CONFIG_STSAFE_POOL
+	op->pool = NULL;
+#endif
+	return stsafe_async_enqueue(dev, op);
+}
+
+int stsafe_async_init(const struct device *dev)
+{
+	const struct stsafe_config *cfg = dev->config;
+	struct stsafe_data *data = dev->data;
+	const struct k_work_queue_config wq_cfg = {
+		.name = dev->name,
+	};
+
+	k_msgq_init(&data->async_msgq, (char *)data->async_buf, sizeof(data->async_buf[0]),
+		    ARRAY_SIZE(data->async_buf));
+	k_work_init(&data->async_work, stsafe_async_work_handler);
+
+	k_work_queue_init(&data->async_q);
+	k_work_queue_start(&data->async_q, cfg->async_stack, cfg->async_stack_size,
+			   CONFIG_STSAFE_ASYNC_PRIORITY, &wq_cfg);
+	return 0;
+}
@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2026, CATIE
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Entropy driver API on top of the secure element's random generator.
+ *
+ * Every instance keeps a pool of random bytes in a ring buffer, refilled on
+ * the instance's STSAFE work queue with the largest Generate Random commands
+ * the frame buffer allows whenever it drops below the watermark. Consumers
+ * are served from the pool; thread callers fall back to a direct command for
+ * whatever the pool cannot cover, ISR callers only get what is pooled.
+ */
+
+#include <zephyr/device.h>
+#include <zephyr/drivers/entropy.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/ring_buffer.h>
+
+#include "stsafe_priv.h"
+
+LOG_MODULE_DECLARE(stsafe, CONFIG_STSAFE_LOG_LEVEL);
+
+/* Generate Random takes a one-byte length */
+#define STSAFE_RANDOM_MAX       255U
+/* Don't bother the chip for less than this */
+#define STSAFE_ENTROPY_MIN_FILL 32U
+
+static uint16_t stsafe_entropy_chunk(const struct device *dev)
+{
+	const struct stsafe_config *cfg = dev->config;
+
+	return MIN(STSAFE_RANDOM_MAX, cfg->i2c_ctx->frame_max - STSAFE_RSP_OVERHEAD);
+}
+
+static void stsafe_entropy_kick(struct stsafe_data *data)
+{
+	uint32_t level;
+
+	K_SPINLOCK(&data->entropy_lock) {
+		level = ring_buf_size_get(&data->entropy_rb);
+	}
+	if (level < CONFIG_STSAFE_ENTROPY_WATERMARK) {
+		k_work_submit_to_queue(&data->async_q, &data->entropy_work);
+	}
+}
+
+static void stsafe_entropy_work_handler(struct k_work *work)
+{
+	struct stsafe_data *data = CONTAINER_OF(work, struct stsafe_data, entropy_work);
+	const struct device *dev = data->dev;
+	uint16_t chunk = stsafe_entropy_chunk(dev);
+
+	for (;;) {
+		uint8_t *dst;
+		uint32_t len;
+
+		/* Single producer: the claimed area is invisible to consumers until finished */
+		K_SPINLOCK(&data->entropy_lock) {
+			len = ring_buf_put_claim(&data->entropy_rb, &dst, chunk);
+		}
+		if (len < MIN(chunk, STSAFE_ENTROPY_MIN_FILL)) {
+			K_SPINLOCK(&data->entropy_lock) {
+				ring_buf_put_finish(&data->entropy_rb, 0);
+			}
+			break;
+		}
+
+		stse_ReturnCode_t rc = STSE_CORE_INVALID_PARAMETER;
+		stse_Handle_t *handle = stsafe_acquire(dev, K_FOREVER);
+
+		if (handle != NULL) {
+			rc = stse_generate_random(handle, dst, len);
+			stsafe_release(dev);
+		}
+
+		K_SPINLOCK(&data->entropy_lock) {
+			ring_buf_put_finish(&data->entropy_rb, rc == STSE_OK ? len : 0);
+		}
+		if (rc != STSE_OK) {
+			LOG_ERR("%s: entropy refill failed: 0x%x", dev->name, rc);
+			break;
+		}
+		LOG_DBG("%s: entropy pool +%u", dev->name, len);
+	}
+}
+
+static uint32_t stsafe_entropy_take(struct stsafe_data *data, uint8_t *buf, uint32_t len)
+{
+	uint32_t got;
+
+	K_SPINLOCK(&data->entropy_lock) {
+		got = ring_buf_get(&data->entropy_rb, buf, len);
+	}
+	return got;
+}
+
+static int stsafe_get_entropy(const struct device *dev, uint8_t *buffer, uint16_t length)
+{
+	struct stsafe_data *data = dev->data;
+
+	if (stsafe_wait_ready(dev, K_FOREVER) != 0) {
+		return -ENODEV;
+	}
+
+	uint32_t got = stsafe_entropy_take(data, buffer, length);
+
+	stsafe_entropy_kick(data);
+	if (got == length) {
+		return 0;
+	}
+
+	/* Pool drained: serve the rest directly rather than wait for the refill */
+	stse_Handle_t *handle = stsafe_acquire(dev, K_FOREVER);
+
+	if (handle == NULL) {
+		return -EIO;
+	}
+
+	uint16_t chunk = stsafe_entropy_chunk(dev);
+	stse_ReturnCode_t rc = STSE_OK;
+
+	while (got < length && rc == STSE_OK) {
+		uint16_t n = MIN(length - got, chunk);
+
+		rc = stse_generate_random(handle, buffer + got, n);
+		got += n;
+	}
+	stsafe_release(dev);
+
+	if (rc != STSE_OK) {
+		LOG_ERR("%s: stse_generate_random failed: 0x%x", dev->name, rc);
+		return -EIO;
+	}
+	return 0;
+}
+
+static int stsafe_get_entropy_isr(const struct device *dev, uint8_t *buffer, uint16_t length,
+				  uint32_t flags)
+{
+	struct stsafe_data *data = dev->data;
+
+	ARG_UNUSED(flags);
+
+	if (!data->ready) {
+		return -ENODEV;
+	}
+
+	/* The bus cannot be driven from here, even with ENTROPY_BUSYWAIT */
+	uint32_t got = stsafe_entropy_take(data, buffer, length);
+
+	stsafe_entropy_kick(data);
+	return got;
+}
+
+DEVICE_API(entropy, stsafe_entropy_api) = {
+	.get_entropy = stsafe_get_entropy,
+	.get_entropy_isr = stsafe_get_entropy_isr,
+};
+
+int stsafe_entropy_init(const struct device *dev)
+{
+	struct stsafe_data *data = dev->data;
+
+	ring_buf_init(&data->entropy_rb, sizeof(data->entropy_pool), data->entropy_pool);
+	k_work_init(&data->entropy_work, stsafe_entropy_work_handler);
+
+	/* Fill the pool in the background, before the first consumer shows up */
+	k_work_submit_to_queue(&data->async_q, &data->entropy_work);
+	return 0;
+}
@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2026, CATIE
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Lock contention profiling.
+ *
+ * Every instance keeps wait and hold time figures for up to
+ * CONFIG_STSAFE_LOCK_PROFILE_THREADS calling threads; threads past that
+ * share a last entry with a NULL thread. The wait is measured from the
+ * call to stsafe_acquire() to the lock being taken, the hold from there to
+ * the outermost stsafe_release(). stsafe_yield() ends a hold and starts a
+ * wait, like a release followed by an acquire.
+ */
+
+#include <zephyr/device.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/util.h>
+#include <string.h>
+
+#include "stsafe_priv.h"
+
+LOG_MODULE_DECLARE(stsafe, CONFIG_STSAFE_LOG_LEVEL);
+
+static stsafe_hold_cb_t stsafe_hold_cb;
+
+static void stsafe_lock_hist(uint32_t *hist, uint32_t us)
+{
+	unsigned int bucket = find_msb_set(us / STSAFE_LOCK_HIST_BASE_US);
+
+	hist[MIN(bucket, STSAFE_LOCK_HIST_BUCKETS - 1)]++;
+}
+
+/* Entry of the calling thread, claimed on first use; caller holds prof_lock */
+static struct stsafe_lock_stats *stsafe_lock_entry(struct stsafe_data *data)
+{
+	k_tid_t self = k_current_get();
+	struct stsafe_lock_stats *free = NULL;
+
+	for (size_t i = 0; i < CONFIG_STSAFE_LOCK_PROFILE_THREADS; i++) {
+		struct stsafe_lock_stats *e = &data->prof[i];
+
+		if (e->thread == self) {
+			return e;
+		}
+		if (e->thread == NULL && free == NULL) {
+			free = e;
+		}
+	}
+	if (free != NULL) {
+		free->thread = self;
+		return free;
+	}
+	return &data->prof[CONFIG_STSAFE_LOCK_PROFILE_THREADS];
+}
+
+void stsafe_lock_profile_acquired(const struct device *dev, uint32_t start, bool ok)
+{
+	struct stsafe_data *data = dev->data;
+	uint32_t now = k_cycle_get_32();
+	uint32_t us = k_cyc_to_us_floor32(now - start);
+
+	K_SPINLOCK(&data->prof_lock) {
+		struct stsafe_lock_stats *e = stsafe_lock_entry(data);
+
+		if (!ok) {
+			e->timeouts++;
+			K_SPINLOCK_BREAK;
+		}
+		e->acquires++;
+		e->wait_total_us += us;
+		e->wait_max_us = MAX(e->wait_max_us, us);
+		stsafe_lock_hist(e->wait_hist, us);
+	}
+
+	/* Only the holder gets here, and it is the only one touching these */
+	if (ok && data->prof_depth++ == 0) {
+		data->prof_held_at = now;
+	}
+}
+
+void stsafe_lock_profile_release(const struct device *dev)
+{
+	struct stsafe_data *data = dev->data;
+
+	if (data->prof_depth == 0 || --data->prof_depth > 0) {
+		return;
+	}
+
+	uint32_t us = k_cyc_to_us_floor32(k_cycle_get_32() - data->prof_held_at);
+
+	K_SPINLOCK(&data->prof_lock) {
+		struct stsafe_lock_stats *e = stsafe_lock_entry(data);
+
+		e->hold_total_us += us;
+		e->hold_max_us = MAX(e->hold_max_us, us);
+		stsafe_lock_hist(e->hold_hist, us);
+	}
+
+	if (CONFIG_STSAFE_LOCK_HOLD_WARN_MS > 0 &&
+	    us > CONFIG_STSAFE_LOCK_HOLD_WARN_MS * USEC_PER_MSEC) {
+		stsafe_hold_cb_t cb = stsafe_hold_cb;
+
+		if (cb != NULL) {
+			cb(dev, k_current_get(), us);
+		} else {
+			LOG_WRN("%s: held %u us by %s", dev->name, us,
+				k_thread_name_get(k_current_get()));
+		}
+	}
+}
+
+int stsafe_lock_stats_get(const struct device *dev, size_t idx, struct stsafe_lock_stats *stats)
+{
+	struct stsafe_data *data = dev->data;
+	int ret = 0;
+
+	if (idx >= ARRAY_SIZE(data->prof)) {
+		return -ENOENT;
+	}
+
+	K_SPINLOCK(&data->prof_lock) {
+		const struct stsafe_lock_stats *e = &data->prof[idx];
+
+		if (e->acquires == 0 && e->timeouts == 0) {
+			ret = -ENODATA;
+			K_SPINLOCK_BREAK;
+		}
+		*stats = *e;
+	}
+	return ret;
+}
+
+void stsafe_lock_stats_reset(const struct device *dev)
+{
+	struct stsafe_data *data = dev->data;
+
+	K_SPINLOCK(&data->prof_lock) {
+		memset(data->prof, 0, sizeof(data->prof));
+	}
+}
+
+void stsafe_lock_hold_cb_set(stsafe_hold_cb_t cb)
+{
+	stsafe_hold_cb = cb;
+}
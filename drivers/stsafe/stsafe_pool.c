@@ -0,0 +1,275 @@
+/*
+ * Copyright (c) 2026, CATIE
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Pools of equivalent STSAFE instances.
+ *
+ * Every acquire goes to the member with the fewest operations in flight,
+ * waiters included, with ties rotated across members. A member whose
+ * commands fail with a communication error CONFIG_STSAFE_POOL_FAIL_THRESHOLD
+ * times in a row, or whose initialization failed, is taken out of rotation
+ * for CONFIG_STSAFE_POOL_RETRY_MS and only used when every member is out.
+ *
+ * With CONFIG_STSAFE_ASYNC, operations can also be queued on the workers of
+ * the members. Each member then has its own thread sleeping through its
+ * command execution, so commands to several members sharing a bus overlap:
+ * the bus carries the next command while the previous chip computes.
+ */
+
+#define DT_DRV_COMPAT st_stsafe_pool
+
+#include <zephyr/device.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include "stsafe_priv.h"
+
+LOG_MODULE_DECLARE(stsafe, CONFIG_STSAFE_LOG_LEVEL);
+
+struct stsafe_pool_member {
+	uint16_t inflight;
+	uint8_t failures;
+	k_timepoint_t down_until;
+};
+
+struct stsafe_pool_config {
+	const struct device *const *devs;
+	uint8_t num_devs;
+};
+
+struct stsafe_pool_data {
+	struct k_spinlock lock;
+	struct stsafe_pool_member *members;
+	uint8_t next;
+};
+
+static bool stsafe_pool_comm_error(stse_ReturnCode_t rc)
+{
+	return rc == STSE_PLATFORM_BUS_ACK_ERROR;
+}
+
+static bool stsafe_pool_is_down(const struct stsafe_pool_member *m)
+{
+	return m->failures >= CONFIG_STSAFE_POOL_FAIL_THRESHOLD &&
+	       !sys_timepoint_expired(m->down_until);
+}
+
+/* Least loaded member not tried yet, members out of rotation last */
+static int stsafe_pool_pick(const struct device *pool, uint32_t tried)
+{
+	const struct stsafe_pool_config *cfg = pool->config;
+	struct stsafe_pool_data *data = pool->data;
+	uint32_t best_score = UINT32_MAX;
+	int best = -1;
+
+	K_SPINLOCK(&data->lock) {
+		for (uint8_t k = 0; k < cfg->num_devs; k++) {
+			uint8_t i = (data->next + k) % cfg->num_devs;
+			struct stsafe_pool_member *m = &data->members[i];
+
+			if (tried & BIT(i)) {
+				continue;
+			}
+
+			uint32_t score = m->inflight | (stsafe_pool_is_down(m) ? BIT(16) : 0);
+
+			if (score < best_score) {
+				best_score = score;
+				best = i;
+			}
+		}
+		if (best >= 0) {
+			data->members[best].inflight++;
+			data->next = (best + 1) % cfg->num_devs;
+		}
+	}
+	return best;
+}
+
+/* Give a member back, with the number of failures to charge it, 0 on success */
+static void stsafe_pool_put(const struct device *pool, int i, uint8_t failures)
+{
+	const struct stsafe_pool_config *cfg = pool->config;
+	struct stsafe_pool_data *data = pool->data;
+	bool went_down = false;
+
+	K_SPINLOCK(&data->lock) {
+		struct stsafe_pool_member *m = &data->members[i];
+
+		m->inflight--;
+		if (failures == 0) {
+			m->failures = 0;
+			K_SPINLOCK_BREAK;
+		}
+
+		m->failures = MIN(m->failures + failures, CONFIG_STSAFE_POOL_FAIL_THRESHOLD);
+		if (m->failures == CONFIG_STSAFE_POOL_FAIL_THRESHOLD) {
+			went_down = !stsafe_pool_is_down(m);
+			m->down_until = sys_timepoint_calc(K_MSEC(CONFIG_STSAFE_POOL_RETRY_MS));
+		}
+	}
+
+	if (went_down) {
+		LOG_WRN("%s: %s out of rotation", pool->name, cfg->devs[i]->name);
+	}
+}
+
+static int stsafe_pool_index(const struct device *pool, const struct device *dev)
+{
+	const struct stsafe_pool_config *cfg = pool->config;
+
+	for (uint8_t i = 0; i < cfg->num_devs; i++) {
+		if (cfg->devs[i] == dev) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+const struct device *stsafe_pool_acquire(const struct device *pool, stse_Handle_t **handle,
+					 k_timeout_t timeout)
+{
+	const struct stsafe_pool_config *cfg = pool->config;
+	k_timepoint_t end = sys_timepoint_calc(timeout);
+	uint32_t tried = 0;
+	int i;
+
+	while ((i = stsafe_pool_pick(pool, tried)) >= 0) {
+		const struct device *dev = cfg->devs[i];
+
+		*handle = stsafe_acquire(dev, sys_timepoint_timeout(end));
+		if (*handle != NULL) {
+			return dev;
+		}
+
+		/* A busy member is not a failed one, one that never came up is out */
+		bool failed = stsafe_wait_ready(dev, K_NO_WAIT) == -ENODEV;
+
+		stsafe_pool_put(pool, i, failed ? CONFIG_STSAFE_POOL_FAIL_THRESHOLD : 0);
+		if (!failed && sys_timepoint_expired(end)) {
+			break;
+		}
+		tried |= BIT(i);
+	}
+	return NULL;
+}
+
+void stsafe_pool_release(const struct device *pool, const struct device *dev,
+			 stse_ReturnCode_t result)
+{
+	int i = stsafe_pool_index(pool, dev);
+
+	stsafe_release(dev);
+	if (i < 0) {
+		LOG_ERR("%s: %s is not a member", pool->name, dev->name);
+		return;
+	}
+	stsafe_pool_put(pool, i, stsafe_pool_comm_error(result) ? 1 : 0);
+}
+
+int stsafe_pool_run(const struct device *pool, stsafe_op_fn_t fn, void *user_data,
+		    k_timeout_t timeout)
+{
+	const struct stsafe_pool_config *cfg = pool->config;
+	k_timepoint_t end = sys_timepoint_calc(timeout);
+	stse_ReturnCode_t rc = STSE_OK;
+
+	if (fn == NULL) {
+		return -EINVAL;
+	}
+
+	/* Fail over to another member when one stops answering */
+	for (uint8_t attempt = 0; attempt < cfg->num_devs; attempt++) {
+		stse_Handle_t *handle;
+		const struct device *dev = stsafe_pool_acquire(pool, &handle,
+							       sys_timepoint_timeout(end));
+
+		if (dev == NULL) {
+			return -EBUSY;
+		}
+
+		rc = fn(handle, user_data);
+		stsafe_pool_release(pool, dev, rc);
+
+		if (!stsafe_pool_comm_error(rc)) {
+			break;
+		}
+		LOG_WRN("%s: %s not answering: 0x%x", pool->name, dev->name, rc);
+	}
+
+	return rc == STSE_OK ? 0 : -EIO;
+}
+
+#ifdef CONFIG_STSAFE_ASYNC
+/* Queue on the least loaded member not tried yet by this operation */
+static int stsafe_pool_dispatch(const struct device *pool, struct stsafe_async_op *op)
+{
+	const struct stsafe_pool_config *cfg = pool->config;
+	int ret = -EAGAIN;
+	int i;
+
+	while ((i = stsafe_pool_pick(pool, op->pool_tried)) >= 0) {
+		ret = stsafe_async_enqueue(cfg->devs[i], op);
+		if (ret == 0) {
+			return 0;
+		}
+		stsafe_pool_put(pool, i, ret == -ENODEV ? CONFIG_STSAFE_POOL_FAIL_THRESHOLD : 0);
+		op->pool_tried |= BIT(i);
+	}
+	return -EAGAIN;
+}
+
+int stsafe_pool_submit(const struct device *pool, struct stsafe_async_op *op)
+{
+	if (op == NULL || op->fn == NULL) {
+		return -EINVAL;
+	}
+
+	op->pool = pool;
+	op->pool_tried = 0;
+	return stsafe_pool_dispatch(pool, op);
+}
+
+bool stsafe_pool_async_done(const struct device *dev, struct stsafe_async_op *op)
+{
+	const struct device *pool = op->pool;
+	int i = stsafe_pool_index(pool, dev);
+	bool failed = stsafe_pool_comm_error(op->result);
+
+	stsafe_pool_put(pool, i, failed ? 1 : 0);
+	if (!failed) {
+		return false;
+	}
+
+	LOG_WRN("%s: %s not answering: 0x%x", pool->name, dev->name, op->result);
+	op->pool_tried |= BIT(i);
+	return stsafe_pool_dispatch(pool, op) == 0;
+}
+#endif /* CONFIG_STSAFE_ASYNC */
+
+static int stsafe_pool_init(const struct device *pool)
+{
+	ARG_UNUSED(pool);
+	return 0;
+}
+
+#define STSAFE_POOL_DEV(node_id, prop, idx) DEVICE_DT_GET(DT_PHANDLE_BY_IDX(node_id, prop, idx)),
+
+#define STSAFE_POOL_INIT(inst)                                                                     \
+	BUILD_ASSERT(DT_INST_PROP_LEN(inst, devices) <= 32, "too many devices in STSAFE pool");    \
+	static const struct device *const stsafe_pool_devs_##inst[] = {                            \
+		DT_INST_FOREACH_PROP_ELEM(inst, devices, STSAFE_POOL_DEV)};                        \
+	static struct stsafe_pool_member                                                           \
+		stsafe_pool_members_##inst[ARRAY_SIZE(stsafe_pool_devs_##inst)];                   \
+	static struct stsafe_pool_data stsafe_pool_data_##inst = {                                 \
+		.members = stsafe_pool_members_##inst,                                             \
+	};                                                                                         \
+	static const struct stsafe_pool_config stsafe_pool_cfg_##inst = {                          \
+		.devs = stsafe_pool_devs_##inst,                                                   \
+		.num_devs = ARRAY_SIZE(stsafe_pool_devs_##inst),                                   \
+	};                                                                                         \
+	DEVICE_DT_INST_DEFINE(inst, stsafe_pool_init, NULL, &stsafe_pool_data_##inst,              \
+			      &stsafe_pool_cfg_##inst, POST_KERNEL, CONFIG_STSAFE_INIT_PRIORITY,   \
+			      NULL);
+
+DT_INST_FOREACH_STATUS_OKAY(STSAFE_POOL_INIT)
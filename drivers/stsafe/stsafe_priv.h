@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2026, CATIE
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ZEPHYR_DRIVERS_STSAFE_STSAFE_PRIV_H_
+#define ZEPHYR_DRIVERS_STSAFE_STSAFE_PRIV_H_
+
+#include <zephyr/device.h>
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/dlist.h>
+#ifdef CONFIG_STSAFE_ENTROPY
+#include <zephyr/drivers/entropy.h>
+#include <zephyr/sys/ring_buffer.h>
+#endif
+
+#include <drivers/stsafe.h>
+
+#include "stse_i2c.h"
+
+/*
+ * A120 instances take bus IDs 0..n-1 and A110 instances follow, so every
+ * instance gets a unique STSELib busID whatever the mix of variants.
+ */
+#define STSAFE_NUM_INSTANCES                                                                       \
+	(DT_NUM_INST_STATUS_OKAY(st_stsafe_a120) + DT_NUM_INST_STATUS_OKAY(st_stsafe_a110))
+
+/* Persistent host key sets an instance can pick with host-key-set */
+#define STSAFE_HOST_KEY_SETS 16
+
+/* Status, length and CRC around the data of a response frame */
+#define STSAFE_RSP_OVERHEAD 5U
+
+#ifdef CONFIG_STSAFE_ZONE_CACHE
+struct stsafe_cache_entry {
+	uint8_t *buf; /* NULL when the entry is free */
+	uint32_t zone;
+	uint16_t offset;
+	uint16_t len;
+	uint32_t last_use;
+};
+#endif
+
+#ifdef CONFIG_STSAFE_ARBITER
+struct stsafe_arbiter {
+	struct k_spinlock lock;
+	sys_dlist_t waiters; /* struct stsafe_arb_waiter, most urgent first */
+	k_tid_t owner;
+	uint16_t depth;
+	int owner_prio;
+	int owner_base_prio;
+	k_timepoint_t owner_deadline;
+	int64_t granted_at;
+	uint32_t hold_avg_ticks;
+};
+#endif
+
+struct stsafe_config {
+	struct i2c_dt_spec i2c;
+	struct gpio_dt_spec reset_gpio;
+	struct stsafe_i2c_ctx *i2c_ctx;
+	int bus_id;
+	uint8_t device_type;
+#ifdef CONFIG_STSAFE_ASYNC
+	k_thread_stack_t *async_stack;
+	size_t async_stack_size;
+#endif
+#ifdef CONFIG_STSAFE_ZONE_CACHE
+	const uint8_t *cache_zones;
+	size_t num_cache_zones;
+#endif
+};
+
+struct stsafe_data {
+	const struct device *dev;
+	stse_Handle_t handle;
+#ifdef CONFIG_STSAFE_ARBITER
+	struct stsafe_arbiter arb;
+#else
+	struct k_mutex lock;
+#endif
+	bool ready;
+#ifdef CONFIG_STSAFE_DEFERRED_INIT
+	struct k_event init_evt;
+	struct k_work init_work;
+#endif
+
+	enum stsafe_mode {
+		STSAFE_MODE_UNSET = 0,
+		STSAFE_MODE_SIMPLE,
+		STSAFE_MODE_LOCKED,
+	} mode;
+	struct k_spinlock mode_lock;
+#ifdef CONFIG_STSAFE_PM
+	bool pm_pinned;
+#endif
+#ifdef CONFIG_STSAFE_FRAME_ARENA
+	/* Nested holders of the borrowed frame buffer */
+	uint16_t frame_refs;
+#endif
+
+#ifdef CONFIG_STSAFE_ASYNC
+	struct k_work_q async_q;
+	struct k_work async_work;
+	struct k_msgq async_msgq;
+	struct stsafe_async_op *async_buf[CONFIG_STSAFE_ASYNC_QUEUE_DEPTH];
+#endif
+
+#ifdef CONFIG_STSAFE_ENTROPY
+	struct ring_buf entropy_rb;
+	struct k_spinlock entropy_lock;
+	struct k_work entropy_work;
+	uint8_t entropy_pool[CONFIG_STSAFE_ENTROPY_POOL_SIZE];
+#endif
+
+#ifdef CONFIG_STSAFE_LOCK_PROFILE
+	struct k_spinlock prof_lock;
+	/* One per thread, plus the entry shared by the threads past those */
+	struct stsafe_lock_stats prof[CONFIG_STSAFE_LOCK_PROFILE_THREADS + 1];
+	uint32_t prof_held_at;
+	uint16_t prof_depth;
+#endif
+
+#ifdef CONFIG_STSAFE_ZONE_CACHE
+	struct k_mutex cache_lock;
+	struct k_heap cache_heap;
+	struct stsafe_cache_entry cache[CONFIG_STSAFE_ZONE_CACHE_ENTRIES];
+	uint32_t cache_clock;
+	size_t cache_max; /* Largest range the empty heap holds */
+	uint8_t cache_mem[CONFIG_STSAFE_ZONE_CACHE_SIZE] __aligned(8);
+#endif
+};
+
+bool stsafe_claim_mode(struct stsafe_data *data, enum stsafe_mode target);
+
+/*
+ * 0 once the device is up, -EAGAIN if its deferred initialization is still
+ * running after @p timeout, -ENODEV if initialization failed.
+ */
+int stsafe_wait_ready(const struct device *dev, k_timeout_t timeout);
+
+#ifdef CONFIG_STSAFE_ARBITER
+void stsafe_arb_init(const struct device *dev);
+/* 0 once held, -EBUSY/-EAGAIN when @p end passed, -ETIME if @p admit and it would */
+int stsafe_arb_lock(const struct device *dev, int prio, k_timepoint_t end, bool admit);
+void stsafe_arb_unlock(const struct device *dev);
+#endif
+
+#ifdef CONFIG_STSAFE_LOCK_PROFILE
+/* @p start is the cycle count at the acquire call, @p ok whether it got the lock */
+void stsafe_lock_profile_acquired(const struct device *dev, uint32_t start, bool ok);
+void stsafe_lock_profile_release(const struct device *dev);
+#endif
+
+#ifdef CONFIG_STSAFE_ASYNC
+int stsafe_async_init(const struct device *dev);
+/* stsafe_submit() without the descriptor checks, the pool fields are left alone */
+int stsafe_async_enqueue(const struct device *dev, struct stsafe_async_op *op);
+#ifdef CONFIG_STSAFE_POOL
+/* From the worker of @p dev once a pool operation ran; true if it was queued again */
+bool stsafe_pool_async_done(const struct device *dev, struct stsafe_async_op *op);
+#endif
+#endif
+
+#ifdef CONFIG_STSAFE_ZONE_CACHE
+void stsafe_cache_init(const struct device *dev);
+#endif
+
+#ifdef CONFIG_STSAFE_ENTROPY
+extern const struct entropy_driver_api stsafe_entropy_api;
+int stsafe_entropy_init(const struct device *dev);
+#define STSAFE_DEVICE_API (&stsafe_entropy_api)
+#else
+#define STSAFE_DEVICE_API NULL
+#endif
+
+#endif /* ZEPHYR_DRIVERS_STSAFE_STSAFE_PRIV_H_ */
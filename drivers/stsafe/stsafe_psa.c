@@ -0,0 +1,293 @@
+/*
+ * Copyright (c) 2026, CATIE
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * PSA Crypto support: ECDSA signature with the private keys held in the
+ * STSAFE key slots through the Mbed TLS secure element interface, and ECDSA
+ * verification offloaded to the chip with a software fallback.
+ */
+
+#include <zephyr/device.h>
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include <psa/crypto_se_driver.h>
+#include <drivers/stsafe_psa.h>
+
+#include "stsafe_priv.h"
+
+LOG_MODULE_DECLARE(stsafe, CONFIG_STSAFE_LOG_LEVEL);
+
+/* Uncompressed point format prefix of PSA public keys */
+#define STSAFE_PSA_POINT_UNCOMPRESSED 0x04
+
+/* SE slot number of a registered key: instance and key slot */
+#define STSAFE_PSA_SLOT_NUMBER(inst, slot) (((psa_key_slot_number_t)(inst) << 8) | (slot))
+
+/* Indexed like the STSELib bus IDs: A120 instances first, then A110 */
+#define STSAFE_PSA_DEV_A120(inst) [inst] = DEVICE_DT_INST_GET(inst),
+#define STSAFE_PSA_DEV_A110(inst)                                                                  \
+	[DT_NUM_INST_STATUS_OKAY(st_stsafe_a120) + inst] = DEVICE_DT_INST_GET(inst),
+
+static const struct device *const stsafe_psa_devs[STSAFE_NUM_INSTANCES] = {
+#define DT_DRV_COMPAT st_stsafe_a120
+	DT_INST_FOREACH_STATUS_OKAY(STSAFE_PSA_DEV_A120)
+#undef DT_DRV_COMPAT
+#define DT_DRV_COMPAT st_stsafe_a110
+	DT_INST_FOREACH_STATUS_OKAY(STSAFE_PSA_DEV_A110)
+#undef DT_DRV_COMPAT
+};
+
+static psa_status_t stsafe_psa_status(stse_ReturnCode_t rc)
+{
+	switch (rc) {
+	case STSE_OK:
+		return PSA_SUCCESS;
+	case STSE_PLATFORM_BUS_ACK_ERROR:
+		return PSA_ERROR_COMMUNICATION_FAILURE;
+	default:
+		return PSA_ERROR_HARDWARE_FAILURE;
+	}
+}
+
+/* Map a NIST P curve size to the STSELib key type and its coordinate size */
+static psa_status_t stsafe_psa_curve(size_t bits, stse_ecc_key_type_t *key_type,
+				     size_t *coord_size)
+{
+	switch (bits) {
+#ifdef CONFIG_STSE_ECC_NIST_P_256
+	case 256:
+		*key_type = STSE_ECC_KT_NIST_P_256;
+		break;
+#endif
+#ifdef CONFIG_STSE_ECC_NIST_P_384
+	case 384:
+		*key_type = STSE_ECC_KT_NIST_P_384;
+		break;
+#endif
+#ifdef CONFIG_STSE_ECC_NIST_P_521
+	case 521:
+		*key_type = STSE_ECC_KT_NIST_P_521;
+		break;
+#endif
+	default:
+		return PSA_ERROR_NOT_SUPPORTED;
+	}
+
+	*coord_size = PSA_BITS_TO_BYTES(bits);
+	return PSA_SUCCESS;
+}
+
+static psa_status_t stsafe_se_validate_slot_number(psa_drv_se_context_t *drv_context,
+						   void *persistent_data,
+						   const psa_key_attributes_t *attributes,
+						   psa_key_creation_method_t method,
+						   psa_key_slot_number_t key_slot)
+{
+	/* The keys are generated or provisioned in the chip, not through PSA */
+	if (method != PSA_KEY_CREATION_REGISTER) {
+		return PSA_ERROR_NOT_SUPPORTED;
+	}
+	if ((key_slot >> 8) >= ARRAY_SIZE(stsafe_psa_devs)) {
+		return PSA_ERROR_INVALID_ARGUMENT;
+	}
+	return PSA_SUCCESS;
+}
+
+static psa_status_t stsafe_se_destroy(psa_drv_se_context_t *drv_context, void *persistent_data,
+				      psa_key_slot_number_t key_slot)
+{
+	/* Only the PSA record goes away, the slot keeps its key */
+	return PSA_SUCCESS;
+}
+
+static psa_status_t stsafe_se_sign(psa_drv_se_context_t *drv_context,
+				   psa_key_slot_number_t key_slot, psa_algorithm_t alg,
+				   const uint8_t *hash, size_t hash_length, uint8_t *signature,
+				   size_t signature_size, size_t *signature_length)
+{
+	const struct device *dev;
+	stse_ecc_key_type_t key_type;
+	size_t coord_size;
+	uint8_t slot = key_slot & 0xFF;
+	psa_status_t status;
+
+	/* The chip draws its own nonce: deterministic ECDSA cannot be honoured */
+	if (!PSA_ALG_IS_RANDOMIZED_ECDSA(alg)) {
+		return PSA_ERROR_NOT_SUPPORTED;
+	}
+	if ((key_slot >> 8) >= ARRAY_SIZE(stsafe_psa_devs)) {
+		return PSA_ERROR_INVALID_ARGUMENT;
+	}
+	dev = stsafe_psa_devs[key_slot >> 8];
+
+	status = stsafe_psa_curve(CONFIG_STSAFE_PSA_KEY_BITS, &key_type, &coord_size);
+	if (status != PSA_SUCCESS) {
+		return status;
+	}
+	if (signature_size < 2 * coord_size) {
+		return PSA_ERROR_BUFFER_TOO_SMALL;
+	}
+
+	stse_Handle_t *handle = stsafe_acquire(dev, K_FOREVER);
+
+	if (handle == NULL) {
+		return PSA_ERROR_BAD_STATE;
+	}
+
+	/* r || s, which is the PSA signature format */
+	stse_ReturnCode_t rc = stse_ecc_generate_signature(handle, slot, key_type, (uint8_t *)hash,
+							   hash_length, signature);
+	stsafe_release(dev);
+
+	if (rc != STSE_OK) {
+		LOG_ERR("%s: signature with slot %u failed: 0x%x", dev->name, slot, rc);
+		return stsafe_psa_status(rc);
+	}
+
+	*signature_length = 2 * coord_size;
+	return PSA_SUCCESS;
+}
+
+static const psa_drv_se_key_management_t stsafe_se_key_management = {
+	.MBEDTLS_PRIVATE(p_validate_slot_number) = stsafe_se_validate_slot_number,
+	.MBEDTLS_PRIVATE(p_destroy) = stsafe_se_destroy,
+};
+
+static const psa_drv_se_asymmetric_t stsafe_se_asymmetric = {
+	.MBEDTLS_PRIVATE(p_sign) = stsafe_se_sign,
+};
+
+static const psa_drv_se_t stsafe_se_driver = {
+	.MBEDTLS_PRIVATE(hal_version) = PSA_DRV_SE_HAL_VERSION,
+	.MBEDTLS_PRIVATE(key_management) = &stsafe_se_key_management,
+	.MBEDTLS_PRIVATE(asymmetric) = &stsafe_se_asymmetric,
+};
+
+psa_status_t stsafe_psa_register_key(uint8_t inst, uint8_t slot)
+{
+	psa_key_attributes_t attr = PSA_KEY_ATTRIBUTES_INIT;
+	psa_status_t status;
+
+	psa_set_key_id(&attr, STSAFE_PSA_KEY_ID(inst, slot));
+	psa_set_key_lifetime(&attr, STSAFE_PSA_LIFETIME);
+	psa_set_key_type(&attr, PSA_KEY_TYPE_ECC_KEY_PAIR(PSA_ECC_FAMILY_SECP_R1));
+	psa_set_key_bits(&attr, CONFIG_STSAFE_PSA_KEY_BITS);
+	psa_set_key_usage_flags(&attr, PSA_KEY_USAGE_SIGN_HASH);
+	psa_set_key_algorithm(&attr, PSA_ALG_ECDSA(PSA_ALG_ANY_HASH));
+	psa_set_key_slot_number(&attr, STSAFE_PSA_SLOT_NUMBER(inst, slot));
+
+	status = mbedtls_psa_register_se_key(&attr);
+	if (status == PSA_ERROR_ALREADY_EXISTS) {
+		return PSA_SUCCESS;
+	}
+	if (status != PSA_SUCCESS) {
+		LOG_ERR("registering slot %u of instance %u failed: %d", slot, inst, status);
+	}
+	return status;
+}
+
+/* Verification on the chip, PSA_ERROR_NOT_SUPPORTED when no instance is free */
+static psa_status_t stsafe_psa_verify_on_chip(const psa_key_attributes_t *attributes,
+					      const uint8_t *key, size_t key_length,
+					      const uint8_t *hash, size_t hash_length,
+					      const uint8_t *signature, size_t signature_length)
+{
+	stse_ecc_key_type_t key_type;
+	size_t coord_size;
+	psa_status_t status;
+
+	status = stsafe_psa_curve(psa_get_key_bits(attributes), &key_type, &coord_size);
+	if (status != PSA_SUCCESS) {
+		return status;
+	}
+	if (key_length != 1 + 2 * coord_size || key[0] != STSAFE_PSA_POINT_UNCOMPRESSED) {
+		return PSA_ERROR_INVALID_ARGUMENT;
+	}
+	if (signature_length != 2 * coord_size) {
+		return PSA_ERROR_INVALID_SIGNATURE;
+	}
+
+	for (size_t i = 0; i < ARRAY_SIZE(stsafe_psa_devs); i++) {
+		const struct device *dev = stsafe_psa_devs[i];
+		const struct stsafe_data *data = dev->data;
+
+		/*
+		 * Only instances already used through acquire/release: taking an
+		 * unused one would lock it out of simple mode for good.
+		 */
+		if (data->mode != STSAFE_MODE_LOCKED) {
+			continue;
+		}
+
+		/* Never queue behind SE traffic: software is the fallback */
+		stse_Handle_t *handle = stsafe_acquire(dev, K_NO_WAIT);
+
+		if (handle == NULL) {
+			continue;
+		}
+
+		PLAT_UI8 valid = 0;
+		stse_ReturnCode_t rc = stse_ecc_verify_signature(
+			handle, key_type, (uint8_t *)key + 1, (uint8_t *)signature,
+			(uint8_t *)hash, hash_length, 0, &valid);
+		stsafe_release(dev);
+
+		if (rc != STSE_OK) {
+			LOG_ERR("%s: signature verification failed: 0x%x", dev->name, rc);
+			return stsafe_psa_status(rc);
+		}
+		return valid ? PSA_SUCCESS : PSA_ERROR_INVALID_SIGNATURE;
+	}
+	return PSA_ERROR_NOT_SUPPORTED;
+}
+
+psa_status_t stsafe_psa_verify_hash(const psa_key_attributes_t *attributes, const uint8_t *key,
+				    size_t key_length, psa_algorithm_t alg, const uint8_t *hash,
+				    size_t hash_length, const uint8_t *signature,
+				    size_t signature_length)
+{
+	psa_status_t status = PSA_ERROR_NOT_SUPPORTED;
+
+	if (!PSA_ALG_IS_ECDSA(alg) ||
+	    psa_get_key_type(attributes) != PSA_KEY_TYPE_ECC_PUBLIC_KEY(PSA_ECC_FAMILY_SECP_R1)) {
+		return PSA_ERROR_NOT_SUPPORTED;
+	}
+
+	status = stsafe_psa_verify_on_chip(attributes, key, key_length, hash, hash_length,
+					   signature, signature_length);
+	if (status != PSA_ERROR_NOT_SUPPORTED) {
+		return status;
+	}
+
+	psa_key_attributes_t attr = PSA_KEY_ATTRIBUTES_INIT;
+	psa_key_id_t id;
+
+	psa_set_key_type(&attr, psa_get_key_type(attributes));
+	psa_set_key_bits(&attr, psa_get_key_bits(attributes));
+	psa_set_key_usage_flags(&attr, PSA_KEY_USAGE_VERIFY_HASH);
+	psa_set_key_algorithm(&attr, alg);
+
+	status = psa_import_key(&attr, key, key_length, &id);
+	if (status != PSA_SUCCESS) {
+		return status;
+	}
+	status = psa_verify_hash(id, alg, hash, hash_length, signature, signature_length);
+	psa_destroy_key(id);
+	return status;
+}
+
+/* The SE interface only takes drivers before psa_crypto_init() */
+static int stsafe_psa_register(void)
+{
+	psa_status_t status = psa_register_se_driver(STSAFE_PSA_LOCATION, &stsafe_se_driver);
+
+	if (status != PSA_SUCCESS) {
+		LOG_ERR("PSA secure element driver registration failed: %d", status);
+		return -EIO;
+	}
+	return 0;
+}
+
+SYS_INIT(stsafe_psa_register, PRE_KERNEL_1, 0);
@@ -0,0 +1,451 @@
+/*
+ * Copyright (c) 2026, CATIE
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Shell commands.
+ *
+ *   stsafe list                              instances, state, mode and bus
+ *   stsafe perso [<device>] [--force]        command access conditions
+ *   stsafe bench <op> <count> <size> [<device>] [--force]
+ *   stsafe trace                             drain the frame trace
+ *   stsafe capture <start|stop|dump>         record traffic for replay
+ *
+ * Without a device argument, commands use the first ready instance. The
+ * benchmark goes through stsafe_acquire() like any other caller, so it can
+ * run next to the application on a production unit, and is refused on an
+ * instance the application drives in simple mode. As the first acquire ties
+ * an instance to locked mode for good, perso and bench also refuse an
+ * instance the application has not used yet unless given --force.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <zephyr/device.h>
+#include <zephyr/kernel.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/util.h>
+
+#include <drivers/stsafe_capture.h>
+
+#include "stsafe_priv.h"
+
+#define STSAFE_SHELL_DEV(node) DEVICE_DT_GET(node),
+
+static const struct device *const stsafe_devs[] = {
+	DT_FOREACH_STATUS_OKAY(st_stsafe_a120, STSAFE_SHELL_DEV)
+	DT_FOREACH_STATUS_OKAY(st_stsafe_a110, STSAFE_SHELL_DEV)
+};
+
+/* Largest payload: a full frame of the largest variant, without its header and CRC */
+#define STSAFE_SHELL_BUF_SIZE (STSAFE_VARIANT_FRAME_MAX - STSAFE_RSP_OVERHEAD)
+#define STSAFE_SHELL_TIMEOUT  K_MSEC(1000)
+
+static uint8_t bench_tx[STSAFE_SHELL_BUF_SIZE];
+static uint8_t bench_rx[STSAFE_SHELL_BUF_SIZE];
+static uint32_t bench_us[CONFIG_STSAFE_SHELL_BENCH_SAMPLES];
+
+static const char *stsafe_mode_str(enum stsafe_mode mode)
+{
+	switch (mode) {
+	case STSAFE_MODE_SIMPLE:
+		return "simple";
+	case STSAFE_MODE_LOCKED:
+		return "locked";
+	default:
+		return "unused";
+	}
+}
+
+static const char *stsafe_ac_str(int ac)
+{
+	switch (ac) {
+	case STSE_CMD_AC_NEVER:
+		return "NEVER";
+	case STSE_CMD_AC_FREE:
+		return "FREE";
+	case STSE_CMD_AC_ADMIN:
+		return "ADMIN";
+	case STSE_CMD_AC_HOST:
+		return "HOST";
+	case STSE_CMD_AC_ADMIN_OR_PWD:
+		return "ADMIN or PASSWORD";
+	case STSE_CMD_AC_ADMIN_OR_HOST:
+		return "ADMIN or HOST";
+	default:
+		return "UNKNOWN";
+	}
+}
+
+/* Strip a trailing --force from the arguments */
+static bool stsafe_shell_force(size_t *argc, char **argv)
+{
+	if (*argc > 1 && strcmp(argv[*argc - 1], "--force") == 0) {
+		(*argc)--;
+		return true;
+	}
+	return false;
+}
+
+/*
+ * An unused instance would be claimed for locked mode by the shell, and a
+ * later stsafe_get_handle() from the application would then fail.
+ */
+static bool stsafe_shell_may_claim(const struct shell *sh, const struct device *dev, bool force)
+{
+	struct stsafe_data *data = dev->data;
+
+	if (data->mode == STSAFE_MODE_UNSET && !force) {
+		shell_error(sh, "%s: not used yet, acquiring it would lock it to acquire/release "
+				"(add --force)",
+			    dev->name);
+		return false;
+	}
+	return true;
+}
+
+/* Named instance, or the first ready one when @p name is NULL */
+static const struct device *stsafe_shell_dev(const struct shell *sh, const char *name)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(stsafe_devs); i++) {
+		const struct device *dev = stsafe_devs[i];
+
+		if (name == NULL ? device_is_ready(dev) : strcmp(dev->name, name) == 0) {
+			return dev;
+		}
+	}
+
+	shell_error(sh, "%s: no such STSAFE instance", name != NULL ? name : "default");
+	return NULL;
+}
+
+static int cmd_list(const struct shell *sh, size_t argc, char **argv)
+{
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	for (size_t i = 0; i < ARRAY_SIZE(stsafe_devs); i++) {
+		const struct device *dev = stsafe_devs[i];
+		const struct stsafe_config *cfg = dev->config;
+		struct stsafe_data *data = dev->data;
+		const char *state = "ready";
+
+		if (!data->ready) {
+			bool starting = stsafe_wait_ready(dev, K_NO_WAIT) == -EAGAIN;
+
+			state = starting ? "starting" : "failed";
+		}
+
+		shell_print(sh, "%-16s %s %-8s %-6s %s@%02x", dev->name,
+			    STSAFE_DEVICE_TYPE(cfg) == STSAFE_A120 ? "A120" : "A110", state,
+			    stsafe_mode_str(data->mode), cfg->i2c.bus->name, cfg->i2c.addr);
+	}
+	return 0;
+}
+
+static int cmd_perso(const struct shell *sh, size_t argc, char **argv)
+{
+	bool force = stsafe_shell_force(&argc, argv);
+	const struct device *dev = stsafe_shell_dev(sh, argc > 1 ? argv[1] : NULL);
+
+	if (dev == NULL) {
+		return -ENODEV;
+	}
+	if (!stsafe_shell_may_claim(sh, dev, force)) {
+		return -EPERM;
+	}
+
+	stse_Handle_t *handle = stsafe_acquire(dev, STSAFE_SHELL_TIMEOUT);
+
+	if (handle == NULL) {
+		shell_error(sh, "%s: cannot acquire the device", dev->name);
+		return -EBUSY;
+	}
+
+	uint8_t cmd_count = 0;
+	stse_ReturnCode_t rc = stsafea_get_command_count(handle, &cmd_count);
+
+	if (rc != STSE_OK) {
+		stsafe_release(dev);
+		shell_error(sh, "failed to get command count: 0x%x", rc);
+		return -EIO;
+	}
+
+	stse_cmd_authorization_record_t records[cmd_count];
+	stse_cmd_authorization_CR_t change_rights;
+
+	rc = stsafea_get_command_AC_table(handle, cmd_count, &change_rights, records);
+	stsafe_release(dev);
+	if (rc != STSE_OK) {
+		shell_error(sh, "failed to get command AC table: 0x%x", rc);
+		return -EIO;
+	}
+
+	shell_print(sh, "%u commands configured (not listed ones are FREE)", cmd_count);
+	for (uint8_t i = 0; i < cmd_count; i++) {
+		const stse_cmd_authorization_record_t *r = &records[i];
+
+		if ((int)r->command_AC == (int)STSE_CMD_AC_FREE) {
+			continue;
+		}
+		shell_print(sh, "  %s %02X: AC=%s, CMD_enc=%c, RSP_enc=%c",
+			    r->extended_header != 0x00 ? "Ext Cmd" : "Cmd",
+			    r->extended_header != 0x00 ? r->extended_header : r->header,
+			    stsafe_ac_str(r->command_AC), r->host_encryption_flags.cmd ? 'Y' : 'N',
+			    r->host_encryption_flags.rsp ? 'Y' : 'N');
+	}
+	return 0;
+}
+
+typedef stse_ReturnCode_t (*stsafe_bench_op_t)(stse_Handle_t *handle, uint16_t size);
+
+static stse_ReturnCode_t bench_echo(stse_Handle_t *handle, uint16_t size)
+{
+	stse_ReturnCode_t rc = stse_device_echo(handle, bench_tx, bench_rx, size);
+
+	if (rc == STSE_OK && memcmp(bench_tx, bench_rx, size) != 0) {
+		return STSE_COMMUNICATION_ERROR;
+	}
+	return rc;
+}
+
+static stse_ReturnCode_t bench_random(stse_Handle_t *handle, uint16_t size)
+{
+	return stse_generate_random(handle, bench_rx, size);
+}
+
+/* Sign a @p size byte digest with the key in slot 0: 32 for P-256, 48 for P-384 */
+static stse_ReturnCode_t bench_sign(stse_Handle_t *handle, uint16_t size)
+{
+	stse_ecc_key_type_t key_type = size == 48 ? STSE_ECC_KT_NIST_P_384 : STSE_ECC_KT_NIST_P_256;
+
+	return stse_ecc_generate_signature(handle, 0, key_type, bench_tx, size, bench_rx);
+}
+
+static stse_ReturnCode_t bench_read(stse_Handle_t *handle, uint16_t size)
+{
+	return stse_data_storage_read_data_zone(handle, 0, 0, bench_rx, size, size, STSE_NO_PROT);
+}
+
+static const struct {
+	const char *name;
+	stsafe_bench_op_t op;
+} bench_ops[] = {
+	{"echo", bench_echo},
+	{"random", bench_random},
+	{"sign", bench_sign},
+	{"read", bench_read},
+};
+
+static int bench_cmp(const void *a, const void *b)
+{
+	uint32_t x = *(const uint32_t *)a;
+	uint32_t y = *(const uint32_t *)b;
+
+	return (x > y) - (x < y);
+}
+
+static uint32_t bench_pct(size_t n, unsigned int pct)
+{
+	return bench_us[(n - 1) * pct / 100];
+}
+
+static int cmd_bench(const struct shell *sh, size_t argc, char **argv)
+{
+	bool force = stsafe_shell_force(&argc, argv);
+	stsafe_bench_op_t op = NULL;
+	int err = 0;
+
+	if (argc < 4) {
+		shell_error(sh, "usage: bench <echo|random|sign|read> <count> <size> [<device>]");
+		return -EINVAL;
+	}
+
+	for (size_t i = 0; i < ARRAY_SIZE(bench_ops); i++) {
+		if (strcmp(argv[1], bench_ops[i].name) == 0) {
+			op = bench_ops[i].op;
+		}
+	}
+
+	unsigned long count = shell_strtoul(argv[2], 0, &err);
+	unsigned long size = shell_strtoul(argv[3], 0, &err);
+
+	if (op == NULL || err != 0 || count == 0) {
+		shell_error(sh, "usage: bench <echo|random|sign|read> <count> <size> [<device>]");
+		return -EINVAL;
+	}
+	if (size == 0 || size > STSAFE_SHELL_BUF_SIZE ||
+	    (op == bench_sign && size != 32 && size != 48)) {
+		shell_error(sh, "bad size %lu", size);
+		return -EINVAL;
+	}
+
+	const struct device *dev = stsafe_shell_dev(sh, argc > 4 ? argv[4] : NULL);
+
+	if (dev == NULL) {
+		return -ENODEV;
+	}
+	if (!stsafe_shell_may_claim(sh, dev, force)) {
+		return -EPERM;
+	}
+
+	for (size_t i = 0; i < size; i++) {
+		bench_tx[i] = (uint8_t)i;
+	}
+
+	unsigned long ok = 0;
+	unsigned long failed = 0;
+	uint64_t total_us = 0;
+	uint32_t min_us = UINT32_MAX;
+	uint32_t max_us = 0;
+
+	for (unsigned long i = 0; i < count; i++) {
+		uint32_t start = k_cycle_get_32();
+		stse_Handle_t *handle = stsafe_acquire(dev, STSAFE_SHELL_TIMEOUT);
+
+		if (handle == NULL) {
+			shell_error(sh, "%s: cannot acquire the device", dev->name);
+			break;
+		}
+
+		stse_ReturnCode_t rc = op(handle, size);
+
+		stsafe_release(dev);
+
+		uint32_t us = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+
+		if (rc != STSE_OK) {
+			if (failed++ == 0) {
+				shell_warn(sh, "iteration %lu failed: 0x%x", i, rc);
+			}
+			continue;
+		}
+		/* Past the sample buffer, the percentiles cover the most recent runs */
+		bench_us[ok % ARRAY_SIZE(bench_us)] = us;
+		min_us = MIN(min_us, us);
+		max_us = MAX(max_us, us);
+		total_us += us;
+		ok++;
+	}
+
+	if (ok == 0) {
+		shell_error(sh, "%s %lu B: no successful iteration", argv[1], size);
+		return -EIO;
+	}
+
+	size_t n = MIN(ok, ARRAY_SIZE(bench_us));
+
+	qsort(bench_us, n, sizeof(bench_us[0]), bench_cmp);
+
+	shell_print(sh, "%s %lu B on %s: %lu ok, %lu failed, %u ops/s", argv[1], size, dev->name,
+		    ok, failed, (uint32_t)(ok * 1000000ULL / MAX(total_us, 1)));
+	/* min and max over the whole run, the percentiles over the samples kept */
+	shell_print(sh, "  min %u  p50 %u  p90 %u  p99 %u  max %u us (avg %u)", min_us,
+		    bench_pct(n, 50), bench_pct(n, 90), bench_pct(n, 99), max_us,
+		    (uint32_t)(total_us / ok));
+	return failed == 0 ? 0 : -EIO;
+}
+
+#ifdef CONFIG_STSAFE_FRAME_TRACE
+static int cmd_trace(const struct shell *sh, size_t argc, char **argv)
+{
+	static const char *const dirs[] = {"tx", "rx", "nack", "txerr"};
+	struct stsafe_trace_rec recs[8];
+	uint32_t lost;
+	size_t n;
+
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	while ((n = stsafe_trace_read(recs, ARRAY_SIZE(recs), &lost)) != 0) {
+		if (lost != 0) {
+			shell_warn(sh, "%u frame(s) lost", lost);
+		}
+		for (size_t i = 0; i < n; i++) {
+			const struct stsafe_trace_rec *r = &recs[i];
+
+			shell_fprintf(sh, SHELL_NORMAL, "%10u bus %u %-5s %02x %4u:",
+				      k_cyc_to_us_floor32(r->cycles), r->bus_id,
+				      r->dir < ARRAY_SIZE(dirs) ? dirs[r->dir] : "?", r->header,
+				      r->len);
+			for (uint8_t b = 0; b < r->prefix_len; b++) {
+				shell_fprintf(sh, SHELL_NORMAL, " %02x", r->prefix[b]);
+			}
+			shell_fprintf(sh, SHELL_NORMAL, "\n");
+		}
+	}
+	return 0;
+}
+#endif
+
+#ifdef CONFIG_STSAFE_CAPTURE
+static int cmd_capture_start(const struct shell *sh, size_t argc, char **argv)
+{
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	stsafe_capture_start();
+	shell_print(sh, "capture started");
+	return 0;
+}
+
+static int cmd_capture_stop(const struct shell *sh, size_t argc, char **argv)
+{
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	shell_print(sh, "capture stopped, %zu bytes", stsafe_capture_stop());
+	return 0;
+}
+
+/* Hex lines that scripts/stsafe_capture.py extracts from the console log */
+static int cmd_capture_dump(const struct shell *sh, size_t argc, char **argv)
+{
+	bool truncated;
+	size_t len;
+	const uint8_t *buf = stsafe_capture_get(&len, &truncated);
+
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	if (truncated) {
+		shell_warn(sh, "capture buffer filled up, later frames missing");
+	}
+	for (size_t off = 0; off < len; off += 32) {
+		shell_fprintf(sh, SHELL_NORMAL, "stcap:");
+		for (size_t i = off; i < MIN(off + 32, len); i++) {
+			shell_fprintf(sh, SHELL_NORMAL, "%02x", buf[i]);
+		}
+		shell_fprintf(sh, SHELL_NORMAL, "\n");
+	}
+	return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(
+	sub_capture, SHELL_CMD_ARG(start, NULL, "Start a new capture", cmd_capture_start, 1, 0),
+	SHELL_CMD_ARG(stop, NULL, "Stop recording", cmd_capture_stop, 1, 0),
+	SHELL_CMD_ARG(dump, NULL, "Print the capture as hex", cmd_capture_dump, 1, 0),
+	SHELL_SUBCMD_SET_END);
+#endif
+
+SHELL_STATIC_SUBCMD_SET_CREATE(
+	sub_stsafe,
+	SHELL_CMD_ARG(list, NULL, "List STSAFE instances", cmd_list, 1, 0),
+	SHELL_CMD_ARG(perso, NULL,
+		      "Dump the command access conditions\n"
+		      "Usage: perso [<device>] [--force]\n"
+		      "--force: use an instance the application has not used yet",
+		      cmd_perso, 1, 2),
+	SHELL_CMD_ARG(bench, NULL,
+		      "Time a command in a loop\n"
+		      "Usage: bench <echo|random|sign|read> <count> <size> [<device>] [--force]\n"
+		      "--force: use an instance the application has not used yet",
+		      cmd_bench, 4, 2),
+	IF_ENABLED(CONFIG_STSAFE_FRAME_TRACE,
+		   (SHELL_CMD_ARG(trace, NULL, "Print and drain the frame trace", cmd_trace, 1,
+				  0),))
+	IF_ENABLED(CONFIG_STSAFE_CAPTURE,
+		   (SHELL_CMD(capture, &sub_capture, "Record the I2C traffic for replay", NULL),))
+	SHELL_SUBCMD_SET_END);
+
+SHELL_CMD_REGISTER(stsafe, &sub_stsafe, "STSAFE secure element commands", NULL);
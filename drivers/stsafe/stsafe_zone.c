@@ -0,0 +1,327 @@
+/*
+ * Copyright (c) 2026, CATIE
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Data partition access through the driver.
+ *
+ * With CONFIG_STSAFE_ZONE_CACHE, reads of the zones listed in the cache-zones
+ * devicetree property are kept in a per-instance heap of
+ * CONFIG_STSAFE_ZONE_CACHE_SIZE bytes. Repeat reads of a cached range are
+ * served from RAM without taking the device. Updates made through
+ * stsafe_update_zone() invalidate the overlapping entries; anything that
+ * writes the zones behind the driver's back must call stsafe_cache_flush().
+ */
+
+#include <zephyr/device.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include "stsafe_priv.h"
+
+LOG_MODULE_DECLARE(stsafe, CONFIG_STSAFE_LOG_LEVEL);
+
+/* Header, option, zone index, offset and CRC around the data of an update */
+#define STSAFE_UPDATE_OVERHEAD 8U
+
+static uint16_t stsafe_zone_chunk(const struct device *dev)
+{
+	const struct stsafe_config *cfg = dev->config;
+
+	return cfg->i2c_ctx->frame_max - STSAFE_RSP_OVERHEAD;
+}
+
+static uint16_t stsafe_zone_update_chunk(const struct device *dev)
+{
+	const struct stsafe_config *cfg = dev->config;
+
+	return cfg->i2c_ctx->frame_max - STSAFE_UPDATE_OVERHEAD;
+}
+
+/* Update in frame-sized pieces, the caller holds the device */
+static stse_ReturnCode_t stsafe_zone_update_chunks(const struct device *dev,
+						   stse_Handle_t *handle, uint32_t zone,
+						   uint16_t offset, const uint8_t *data,
+						   uint16_t len)
+{
+	uint16_t chunk = stsafe_zone_update_chunk(dev);
+	stse_ReturnCode_t rc = STSE_OK;
+
+	for (uint16_t done = 0; done < len && rc == STSE_OK; done += chunk) {
+		rc = stse_data_storage_update_data_zone(handle, zone, offset + done,
+							(uint8_t *)data + done,
+							MIN(chunk, len - done),
+							STSE_NON_ATOMIC_ACCESS, STSE_NO_PROT);
+	}
+	return rc;
+}
+
+#ifdef CONFIG_STSAFE_ZONE_CACHE
+static bool stsafe_cache_zone_enabled(const struct stsafe_config *cfg, uint32_t zone)
+{
+	for (size_t i = 0; i < cfg->num_cache_zones; i++) {
+		if (cfg->cache_zones[i] == zone) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static void stsafe_cache_drop(struct stsafe_data *data, struct stsafe_cache_entry *e)
+{
+	k_heap_free(&data->cache_heap, e->buf);
+	e->buf = NULL;
+}
+
+static bool stsafe_cache_lookup(struct stsafe_data *data, uint32_t zone, uint16_t offset,
+				uint8_t *buf, uint16_t len)
+{
+	bool hit = false;
+
+	k_mutex_lock(&data->cache_lock, K_FOREVER);
+	ARRAY_FOR_EACH_PTR(data->cache, e) {
+		if (e->buf != NULL && e->zone == zone && offset >= e->offset &&
+		    offset + len <= e->offset + e->len) {
+			memcpy(buf, e->buf + (offset - e->offset), len);
+			e->last_use = ++data->cache_clock;
+			hit = true;
+			break;
+		}
+	}
+	k_mutex_unlock(&data->cache_lock);
+	return hit;
+}
+
+/* Keep a copy of a range just read, evicting the least recently used entries */
+static void stsafe_cache_insert(struct stsafe_data *data, uint32_t zone, uint16_t offset,
+				const uint8_t *buf, uint16_t len)
+{
+	/* Evicting everything would not make room for it */
+	if (len > data->cache_max) {
+		return;
+	}
+
+	k_mutex_lock(&data->cache_lock, K_FOREVER);
+
+	struct stsafe_cache_entry *slot = NULL;
+	uint8_t *copy;
+
+	for (;;) {
+		struct stsafe_cache_entry *lru = NULL;
+
+		slot = NULL;
+		ARRAY_FOR_EACH_PTR(data->cache, e) {
+			if (e->buf == NULL) {
+				slot = e;
+			} else if (lru == NULL || e->last_use < lru->last_use) {
+				lru = e;
+			}
+		}
+
+		copy = slot != NULL ? k_heap_alloc(&data->cache_heap, len, K_NO_WAIT) : NULL;
+		if (copy != NULL || lru == NULL) {
+			break;
+		}
+		stsafe_cache_drop(data, lru);
+	}
+
+	if (copy != NULL) {
+		memcpy(copy, buf, len);
+		*slot = (struct stsafe_cache_entry){
+			.buf = copy,
+			.zone = zone,
+			.offset = offset,
+			.len = len,
+			.last_use = ++data->cache_clock,
+		};
+	}
+	k_mutex_unlock(&data->cache_lock);
+}
+
+static void stsafe_cache_invalidate(struct stsafe_data *data, uint32_t zone, uint16_t offset,
+				    uint16_t len)
+{
+	k_mutex_lock(&data->cache_lock, K_FOREVER);
+	ARRAY_FOR_EACH_PTR(data->cache, e) {
+		if (e->buf != NULL && (zone == STSAFE_CACHE_ALL ||
+				       (e->zone == zone && offset < e->offset + e->len &&
+					e->offset < offset + len))) {
+			stsafe_cache_drop(data, e);
+		}
+	}
+	k_mutex_unlock(&data->cache_lock);
+}
+
+void stsafe_cache_flush(const struct device *dev, uint32_t zone)
+{
+	stsafe_cache_invalidate(dev->data, zone, 0, UINT16_MAX);
+	LOG_DBG("%s: cache flushed (zone %d)", dev->name, (int)zone);
+}
+
+void stsafe_cache_init(const struct device *dev)
+{
+	struct stsafe_data *data = dev->data;
+
+	k_mutex_init(&data->cache_lock);
+	k_heap_init(&data->cache_heap, data->cache_mem, sizeof(data->cache_mem));
+
+	/* Chunk headers take part of the heap: find the largest range it holds */
+	size_t lo = 0;
+	size_t hi = sizeof(data->cache_mem);
+
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo + 1) / 2;
+		void *p = k_heap_alloc(&data->cache_heap, mid, K_NO_WAIT);
+
+		if (p != NULL) {
+			k_heap_free(&data->cache_heap, p);
+			lo = mid;
+		} else {
+			hi = mid - 1;
+		}
+	}
+	data->cache_max = lo;
+}
+#endif /* CONFIG_STSAFE_ZONE_CACHE */
+
+int stsafe_read_zone(const struct device *dev, uint32_t zone, uint16_t offset, uint8_t *buf,
+		     uint16_t len, k_timeout_t timeout)
+{
+	if (buf == NULL || len == 0) {
+		return -EINVAL;
+	}
+
+#ifdef CONFIG_STSAFE_ZONE_CACHE
+	const struct stsafe_config *cfg = dev->config;
+	bool cacheable = stsafe_cache_zone_enabled(cfg, zone);
+
+	if (cacheable && stsafe_cache_lookup(dev->data, zone, offset, buf, len)) {
+		return 0;
+	}
+#endif
+
+	stse_Handle_t *handle = stsafe_acquire(dev, timeout);
+
+	if (handle == NULL) {
+		return -EBUSY;
+	}
+
+	stse_ReturnCode_t rc = stse_data_storage_read_data_zone(
+		handle, zone, offset, buf, len, MIN(len, stsafe_zone_chunk(dev)), STSE_NO_PROT);
+
+#ifdef CONFIG_STSAFE_ZONE_CACHE
+	/* Still holding the device: no update can slip in before the insert */
+	if (rc == STSE_OK && cacheable) {
+		stsafe_cache_insert(dev->data, zone, offset, buf, len);
+	}
+#endif
+	stsafe_release(dev);
+
+	if (rc != STSE_OK) {
+		LOG_ERR("%s: read of zone %u failed: 0x%x", dev->name, zone, rc);
+		return -EIO;
+	}
+	return 0;
+}
+
+int stsafe_update_zone(const struct device *dev, uint32_t zone, uint16_t offset,
+		       const uint8_t *data, uint16_t len, k_timeout_t timeout)
+{
+	if (data == NULL || len == 0) {
+		return -EINVAL;
+	}
+
+	stse_Handle_t *handle = stsafe_acquire(dev, timeout);
+
+	if (handle == NULL) {
+		return -EBUSY;
+	}
+
+	stse_ReturnCode_t rc = stsafe_zone_update_chunks(dev, handle, zone, offset, data, len);
+
+#ifdef CONFIG_STSAFE_ZONE_CACHE
+	/* Also on failure: the zone content is unknown after a partial write */
+	stsafe_cache_invalidate(dev->data, zone, offset, len);
+#endif
+	stsafe_release(dev);
+
+	if (rc != STSE_OK) {
+		LOG_ERR("%s: update of zone %u failed: 0x%x", dev->name, zone, rc);
+		return -EIO;
+	}
+	return 0;
+}
+
+static int stsafe_zone_stream(const struct device *dev, bool write, uint32_t zone,
+			      uint16_t offset, size_t len, uint8_t *buf, size_t buf_size,
+			      stsafe_zone_stream_cb_t cb, void *user_data, k_timeout_t timeout)
+{
+	if (buf == NULL || buf_size == 0 || cb == NULL || offset + len > UINT16_MAX + 1) {
+		return -EINVAL;
+	}
+
+	uint16_t chunk = MIN(buf_size, write ? stsafe_zone_update_chunk(dev)
+					     : stsafe_zone_chunk(dev));
+	stse_Handle_t *handle = stsafe_acquire(dev, timeout);
+	stse_ReturnCode_t rc = STSE_OK;
+	int ret = 0;
+
+	if (handle == NULL) {
+		return -EBUSY;
+	}
+
+	for (size_t done = 0; done < len; done += chunk) {
+		uint16_t n = MIN(chunk, len - done);
+
+		if (write) {
+			ret = cb(buf, n, user_data);
+			if (ret != 0) {
+				break;
+			}
+			rc = stse_data_storage_update_data_zone(handle, zone, offset + done, buf,
+								n, STSE_NON_ATOMIC_ACCESS,
+								STSE_NO_PROT);
+		} else {
+			rc = stse_data_storage_read_data_zone(handle, zone, offset + done, buf, n,
+							      n, STSE_NO_PROT);
+		}
+		if (rc != STSE_OK) {
+			break;
+		}
+		if (!write) {
+			ret = cb(buf, n, user_data);
+			if (ret != 0) {
+				break;
+			}
+		}
+	}
+
+#ifdef CONFIG_STSAFE_ZONE_CACHE
+	if (write) {
+		stsafe_cache_invalidate(dev->data, zone, offset, MIN(len, UINT16_MAX));
+	}
+#endif
+	stsafe_release(dev);
+
+	if (rc != STSE_OK) {
+		LOG_ERR("%s: %s of zone %u failed: 0x%x", dev->name, write ? "update" : "read",
+			zone, rc);
+		return -EIO;
+	}
+	return ret;
+}
+
+int stsafe_read_zone_stream(const struct device *dev, uint32_t zone, uint16_t offset, size_t len,
+			    uint8_t *buf, size_t buf_size, stsafe_zone_stream_cb_t cb,
+			    void *user_data, k_timeout_t timeout)
+{
+	return stsafe_zone_stream(dev, false, zone, offset, len, buf, buf_size, cb, user_data,
+				  timeout);
+}
+
+int stsafe_update_zone_stream(const struct device *dev, uint32_t zone, uint16_t offset,
+			      size_t len, uint8_t *buf, size_t buf_size,
+			      stsafe_zone_stream_cb_t cb, void *user_data, k_timeout_t timeout)
+{
+	return stsafe_zone_stream(dev, true, zone, offset, len, buf, buf_size, cb, user_data,
+				  timeout);
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2026, CATIE
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ZEPHYR_INCLUDE_DRIVERS_EMUL_STSAFE_H_
+#define ZEPHYR_INCLUDE_DRIVERS_EMUL_STSAFE_H_
+
+#include <zephyr/drivers/emul.h>
+
+/*
+ * Backend API of the STSAFE-A1xx I2C emulator.
+ *
+ * The emulator answers the STSELib frame format (header, payload, CRC16) on an
+ * emulated I2C bus and models the chip's execution time: after a command frame
+ * is written, reads are NACKed until the configured execution time of that
+ * command has elapsed, just like the real part while it computes. After a
+ * Hibernate command, the next write wakes the emulator up and is NACKed, as
+ * are further transfers until the wake-up time has elapsed.
+ *
+ * With CONFIG_EMUL_STSAFE_REPLAY, responses and execution times come from a
+ * capture of real traffic (see drivers/stsafe_capture.h).
+ */
+
+/* Command codes understood by the emulator (low 5 bits of the header byte). */
+#define EMUL_STSAFE_CMD_ECHO            0x00
+#define EMUL_STSAFE_CMD_GENERATE_RANDOM 0x02
+#define EMUL_STSAFE_CMD_READ            0x05
+#define EMUL_STSAFE_CMD_UPDATE          0x06
+#define EMUL_STSAFE_CMD_HIBERNATE       0x0D
+#define EMUL_STSAFE_CMD_QUERY           0x14
+#define EMUL_STSAFE_CMD_COUNT           32
+
+/* Response status codes returned by the emulator. */
+#define EMUL_STSAFE_RSP_OK                0x00
+#define EMUL_STSAFE_RSP_COMM_ERROR        0x01
+#define EMUL_STSAFE_RSP_INCONSISTENT_DATA 0x02
+
+/**
+ * @brief Set the execution time of a command.
+ *
+ * @param target Emulator instance.
+ * @param cmd Command code (EMUL_STSAFE_CMD_*).
+ * @param exec_us Time during which the emulator NACKs reads after the command.
+ */
+void emul_stsafe_set_exec_time(const struct emul *target, uint8_t cmd, uint32_t exec_us);
+
+/**
+ * @brief Get a pointer to the backing memory of a data partition zone.
+ *
+ * @param target Emulator instance.
+ * @param zone Zone index.
+ * @param size Filled with the zone size in bytes.
+ *
+ * @return Pointer to the zone content, or NULL if the zone does not exist.
+ */
+uint8_t *emul_stsafe_get_zone(const struct emul *target, uint8_t zone, size_t *size);
+
+/**
+ * @brief Set the canned response returned for a query tag.
+ *
+ * Tags that were never set are answered with CONFIG_EMUL_STSAFE_QUERY_DEFAULT_LEN
+ * zero bytes, which reads as an unprovisioned, all-FREE chip.
+ *
+ * @return 0 on success, -ENOMEM if the query table is full or @p len is too large.
+ */
+int emul_stsafe_set_query_response(const struct emul *target, uint8_t tag, const uint8_t *data,
+				   size_t len);
+
+/** Number of command frames received since boot. */
+uint32_t emul_stsafe_get_cmd_count(const struct emul *target);
+
+/** Number of reads NACKed because the emulated chip was still busy. */
+uint32_t emul_stsafe_get_nack_count(const struct emul *target);
+
+#ifdef CONFIG_EMUL_STSAFE_REPLAY
+/**
+ * Number of commands that differed from the capture being replayed, either
+ * answered by the model or, for other arguments only, from the capture.
+ */
+uint32_t emul_stsafe_get_replay_mismatches(const struct emul *target);
+
+/**
+ * @brief Start replaying the capture from its beginning.
+ *
+ * Commands before this call, such as the bring-up of the driver, are answered
+ * by the model and neither consume the capture nor count as mismatches. Arm
+ * right before the traffic the capture was recorded over.
+ */
+void emul_stsafe_replay_arm(const struct emul *target);
+#endif
+
+#endif /* ZEPHYR_INCLUDE_DRIVERS_EMUL_STSAFE_H_ */
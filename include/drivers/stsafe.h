@@ -11,8 +11,438 @@
 #include <stse_platform_generic.h>
 #include "stselib.h"
 
+/**
+ * @brief Operation run with the device acquired.
+ *
+ * Typically a short sequence of stsafea_*() / stse_*() calls on @p handle,
+ * with its buffers reached through @p user_data.
+ */
+typedef stse_ReturnCode_t (*stsafe_op_fn_t)(stse_Handle_t *handle, void *user_data);
+
 stse_Handle_t *stsafe_get_handle(const struct device *dev);
 stse_Handle_t *stsafe_acquire(const struct device *dev, k_timeout_t timeout);
 void stsafe_release(const struct device *dev);
 
+/** @brief One operation of a transaction. */
+struct stsafe_txn_op {
+	/** Operation to run. */
+	stsafe_op_fn_t fn;
+	/** Opaque argument passed to @ref fn. */
+	void *user_data;
+	/** Result of @ref fn, set for the operations that ran. */
+	stse_ReturnCode_t result;
+};
+
+/** stsafe_transact() flag: skip the operations after the first failure. */
+#define STSAFE_TXN_STOP_ON_ERROR BIT(0)
+
+/**
+ * @brief Run a batch of operations under a single acquire.
+ *
+ * The device is acquired and woken up once for the whole batch, and no
+ * other caller gets in between two operations, so a host session carries
+ * on from one operation to the next.
+ *
+ * @param dev STSAFE device.
+ * @param ops Operations, run in order.
+ * @param num_ops Number of operations.
+ * @param flags STSAFE_TXN_* flags.
+ * @param timeout Time to wait for the device.
+ *
+ * @return Number of operations run, each with its result, or
+ *         -EINVAL if an operation has no function,
+ *         -EBUSY if the device could not be acquired within @p timeout.
+ */
+int stsafe_transact(const struct device *dev, struct stsafe_txn_op *ops, size_t num_ops,
+		    uint32_t flags, k_timeout_t timeout);
+
+#ifdef CONFIG_STSAFE_ARBITER
+/**
+ * @brief Acquire the device with an explicit priority and deadline.
+ *
+ * Waiters get the device by @p prio first (thread priority scale, lower is
+ * more urgent), then by earliest deadline. stsafe_acquire() uses the
+ * calling thread's priority and its timeout as deadline. Requests that
+ * would not get the device before @p deadline, going by the average time
+ * the device is held, are turned down without waiting. While a thread
+ * waits, the holder inherits that thread's own priority, not @p prio.
+ *
+ * @param dev STSAFE device.
+ * @param prio Request priority.
+ * @param deadline Latest time to get the device.
+ *
+ * @return Handle to release with stsafe_release(), or NULL.
+ */
+stse_Handle_t *stsafe_acquire_deadline(const struct device *dev, int prio, k_timeout_t deadline);
+
+/**
+ * @brief Let more urgent requests run between two commands.
+ *
+ * For long sequences of commands under one acquire. If a waiter ranks
+ * above the caller's request, the device is handed over and taken back
+ * once the more urgent requests are done, without a deadline. Does nothing
+ * inside nested acquires.
+ *
+ * @retval 0 The caller holds the device.
+ * @retval -EPERM The caller does not hold the device.
+ */
+int stsafe_yield(const struct device *dev);
+#endif
+
+/**
+ * @brief Read from a data partition zone.
+ *
+ * Acquires the device (locked mode) for the duration of the read. Served
+ * from RAM when the range is cached, see CONFIG_STSAFE_ZONE_CACHE.
+ *
+ * @retval 0 Success.
+ * @retval -EINVAL No buffer or zero length.
+ * @retval -EBUSY Device could not be acquired within @p timeout.
+ * @retval -EIO Command failed.
+ */
+int stsafe_read_zone(const struct device *dev, uint32_t zone, uint16_t offset, uint8_t *buf,
+		     uint16_t len, k_timeout_t timeout);
+
+/**
+ * @brief Write to a data partition zone.
+ *
+ * Acquires the device (locked mode) for the duration of the update and
+ * drops the cached ranges it overlaps. Data longer than one command frame
+ * is written in several non-atomic updates.
+ *
+ * @retval 0 Success.
+ * @retval -EINVAL No data or zero length.
+ * @retval -EBUSY Device could not be acquired within @p timeout.
+ * @retval -EIO Command failed.
+ */
+int stsafe_update_zone(const struct device *dev, uint32_t zone, uint16_t offset,
+		       const uint8_t *data, uint16_t len, k_timeout_t timeout);
+
+/**
+ * @brief Callback of the streaming zone transfers.
+ *
+ * Called with the device held, so it should only copy, hash or checksum the
+ * chunk. A non-zero return aborts the transfer and is returned to the caller.
+ *
+ * @param chunk Data just read, or buffer to fill with the data to write next.
+ * @param len Length of the chunk.
+ * @param user_data Argument given to the transfer.
+ */
+typedef int (*stsafe_zone_stream_cb_t)(uint8_t *chunk, uint16_t len, void *user_data);
+
+/**
+ * @brief Read a range of a zone of any length through a callback.
+ *
+ * The range is read in chunks of up to @p buf_size bytes, capped to the
+ * largest response of the device variant, all under one acquire. Each
+ * chunk lands at the start of @p buf and is handed to @p cb in order.
+ * Bypasses the zone cache.
+ *
+ * @retval 0 Success.
+ * @retval -EINVAL No buffer or callback, or the range is past 64 KiB.
+ * @retval -EBUSY Device could not be acquired within @p timeout.
+ * @retval -EIO Command failed.
+ * @return The non-zero value returned by @p cb.
+ */
+int stsafe_read_zone_stream(const struct device *dev, uint32_t zone, uint16_t offset, size_t len,
+			    uint8_t *buf, size_t buf_size, stsafe_zone_stream_cb_t cb,
+			    void *user_data, k_timeout_t timeout);
+
+/**
+ * @brief Write a range of a zone of any length through a callback.
+ *
+ * Counterpart of stsafe_read_zone_stream(): @p cb fills each chunk of
+ * @p buf before it is written. Chunks are separate non-atomic updates, so
+ * a failure leaves the range partly written.
+ *
+ * @retval 0 Success.
+ * @retval -EINVAL No buffer or callback, or the range is past 64 KiB.
+ * @retval -EBUSY Device could not be acquired within @p timeout.
+ * @retval -EIO Command failed.
+ * @return The non-zero value returned by @p cb.
+ */
+int stsafe_update_zone_stream(const struct device *dev, uint32_t zone, uint16_t offset,
+			      size_t len, uint8_t *buf, size_t buf_size,
+			      stsafe_zone_stream_cb_t cb, void *user_data, k_timeout_t timeout);
+
+#ifdef CONFIG_STSAFE_ZONE_CACHE
+/** Zone argument of stsafe_cache_flush() selecting every zone. */
+#define STSAFE_CACHE_ALL UINT32_MAX
+
+/**
+ * @brief Drop the cached ranges of a zone, or of all zones.
+ *
+ * Needed after writing a cached zone without stsafe_update_zone(), e.g.
+ * with the STSELib API directly.
+ */
+void stsafe_cache_flush(const struct device *dev, uint32_t zone);
+#endif
+
+#ifdef CONFIG_STSAFE_LOCK_PROFILE
+/** Number of wait and hold time histogram buckets. */
+#define STSAFE_LOCK_HIST_BUCKETS 12
+/** Upper bound of the first bucket; each next bucket doubles it. */
+#define STSAFE_LOCK_HIST_BASE_US 128
+
+/** @brief Locked mode figures of one thread on one instance. */
+struct stsafe_lock_stats {
+	/** Thread, or NULL for the threads past CONFIG_STSAFE_LOCK_PROFILE_THREADS. */
+	k_tid_t thread;
+	/** Successful acquires. */
+	uint32_t acquires;
+	/** Acquires that timed out or were turned down. */
+	uint32_t timeouts;
+	/** Longest and total time waited in successful acquires. */
+	uint32_t wait_max_us;
+	uint64_t wait_total_us;
+	/** Longest and total time between acquire and outermost release. */
+	uint32_t hold_max_us;
+	uint64_t hold_total_us;
+	/** Histograms, bucketed like struct stsafe_cmd_stats. */
+	uint32_t wait_hist[STSAFE_LOCK_HIST_BUCKETS];
+	uint32_t hold_hist[STSAFE_LOCK_HIST_BUCKETS];
+};
+
+/**
+ * @brief Called on release when a thread held the device longer than
+ * CONFIG_STSAFE_LOCK_HOLD_WARN_MS, from the releasing thread.
+ */
+typedef void (*stsafe_hold_cb_t)(const struct device *dev, k_tid_t thread, uint32_t held_us);
+
+/**
+ * @brief Get the figures of the @p idx-th profiled thread of an instance.
+ *
+ * Iterate from 0 until -ENOENT; unused entries return -ENODATA.
+ *
+ * @retval 0 Success.
+ * @retval -ENODATA Entry not used.
+ * @retval -ENOENT @p idx past the last entry.
+ */
+int stsafe_lock_stats_get(const struct device *dev, size_t idx, struct stsafe_lock_stats *stats);
+
+/** @brief Clear the lock figures of an instance. */
+void stsafe_lock_stats_reset(const struct device *dev);
+
+/**
+ * @brief Replace the "held too long" warning with a callback.
+ *
+ * Applies to all instances; NULL restores the log warning.
+ */
+void stsafe_lock_hold_cb_set(stsafe_hold_cb_t cb);
+#endif /* CONFIG_STSAFE_LOCK_PROFILE */
+
+#ifdef CONFIG_STSAFE_STATS
+/** Number of command codes tracked (low 5 bits of the command header). */
+#define STSAFE_STATS_CMDS          32
+/** Number of latency histogram buckets. */
+#define STSAFE_STATS_HIST_BUCKETS  12
+/** Upper bound of the first latency bucket; each next bucket doubles it. */
+#define STSAFE_STATS_HIST_BASE_US  128
+
+/** @brief Statistics of one command code on one instance. */
+struct stsafe_cmd_stats {
+	/** Responses received. */
+	uint32_t count;
+	/** Response reads NACKed while the chip was busy. */
+	uint32_t polls;
+	/** Slowest command, from the end of the send to the response. */
+	uint32_t max_us;
+	/** Sum of the latencies, for the average. */
+	uint64_t total_us;
+	/**
+	 * Latency histogram: bucket 0 counts commands under
+	 * STSAFE_STATS_HIST_BASE_US, bucket n those under twice the bound of
+	 * bucket n - 1, and the last bucket everything slower.
+	 */
+	uint32_t hist[STSAFE_STATS_HIST_BUCKETS];
+};
+
+/**
+ * @brief Get the statistics of a command code.
+ *
+ * Bus counters (frames, bytes, NACKs) are in the "stsafe_bus" stats group
+ * named after the device, CRC16 and CMAC time in the "stsafe_host" group.
+ *
+ * @retval 0 Success.
+ * @retval -EINVAL @p cmd out of range.
+ */
+int stsafe_cmd_stats_get(const struct device *dev, uint8_t cmd, struct stsafe_cmd_stats *stats);
+
+/** @brief Clear the command statistics and bus counters of an instance. */
+void stsafe_stats_reset(const struct device *dev);
+#endif /* CONFIG_STSAFE_STATS */
+
+#ifdef CONFIG_STSAFE_FRAME_TRACE
+/** @brief What a trace record saw on the bus. */
+enum stsafe_trace_dir {
+	/** Command frame sent. */
+	STSAFE_TRACE_TX,
+	/** Response frame received. */
+	STSAFE_TRACE_RX,
+	/** Response read NACKed, the chip is still busy. */
+	STSAFE_TRACE_NACK,
+	/** Command frame not acknowledged. */
+	STSAFE_TRACE_TX_ERROR,
+};
+
+/** @brief One frame of the binary trace. */
+struct stsafe_trace_rec {
+	/** k_cycle_get_32() when the transfer completed. */
+	uint32_t cycles;
+	/** STSELib bus ID of the instance. */
+	uint8_t bus_id;
+	/** enum stsafe_trace_dir. */
+	uint8_t dir;
+	/** Command header on TX, response status on RX. */
+	uint8_t header;
+	/** Bytes of the frame kept in @ref prefix. */
+	uint8_t prefix_len;
+	/** Frame length on the wire. */
+	uint16_t len;
+	/** Start of the frame. */
+	uint8_t prefix[CONFIG_STSAFE_FRAME_TRACE_PAYLOAD];
+};
+
+/**
+ * @brief Take the oldest records out of the frame trace.
+ *
+ * @param recs Destination.
+ * @param max Capacity of @p recs.
+ * @param lost If not NULL, set to the records overwritten since the last read.
+ *
+ * @return Number of records copied.
+ */
+size_t stsafe_trace_read(struct stsafe_trace_rec *recs, size_t max, uint32_t *lost);
+
+/** @brief Drop every record of the frame trace. */
+void stsafe_trace_clear(void);
+#endif /* CONFIG_STSAFE_FRAME_TRACE */
+
+#ifdef CONFIG_STSAFE_POOL
+/**
+ * @brief Acquire the least loaded instance of an st,stsafe-pool.
+ *
+ * Instances that stopped answering are skipped while others are available.
+ * If the chosen instance cannot be acquired in time or never came up, the
+ * next one is tried within the same @p timeout.
+ *
+ * @param pool Pool device.
+ * @param handle Filled with the handle of the acquired instance.
+ * @param timeout Overall time to wait for an instance.
+ *
+ * @return The acquired instance, to pass to stsafe_pool_release(), or NULL.
+ */
+const struct device *stsafe_pool_acquire(const struct device *pool, stse_Handle_t **handle,
+					 k_timeout_t timeout);
+
+/**
+ * @brief Release an instance acquired with stsafe_pool_acquire().
+ *
+ * @p result is the outcome of the last command, used to take instances
+ * that stop answering out of rotation.
+ */
+void stsafe_pool_release(const struct device *pool, const struct device *dev,
+			 stse_ReturnCode_t result);
+
+/**
+ * @brief Run an operation on the least loaded instance of a pool.
+ *
+ * Retries on another instance when the operation fails with a
+ * communication error, at most once per instance.
+ *
+ * @retval 0 Success.
+ * @retval -EINVAL No operation function given.
+ * @retval -EBUSY No instance could be acquired within @p timeout.
+ * @retval -EIO Operation failed.
+ */
+int stsafe_pool_run(const struct device *pool, stsafe_op_fn_t fn, void *user_data,
+		    k_timeout_t timeout);
+#endif /* CONFIG_STSAFE_POOL */
+
+#ifdef CONFIG_STSAFE_ASYNC
+
+struct stsafe_async_op;
+
+/** @brief Completion callback, called from the STSAFE worker thread. */
+typedef void (*stsafe_async_cb_t)(const struct device *dev, struct stsafe_async_op *op);
+
+/**
+ * @brief Asynchronous operation descriptor.
+ *
+ * Owned by the caller and must stay valid, together with the buffers it
+ * references, until completion is reported.
+ */
+struct stsafe_async_op {
+	/** Operation to run. */
+	stsafe_op_fn_t fn;
+	/** Opaque argument passed to @ref fn, usually the operation buffers. */
+	void *user_data;
+	/** Optional completion callback. */
+	stsafe_async_cb_t cb;
+	/** Optional signal raised with @ref result on completion. */
+	struct k_poll_signal *signal;
+	/** Result of @ref fn, valid once completion is reported. */
+	stse_ReturnCode_t result;
+#ifdef CONFIG_STSAFE_POOL
+	/* Private: pool the operation was submitted to, and members tried */
+	const struct device *pool;
+	uint32_t pool_tried;
+#endif
+};
+
+#ifdef CONFIG_STSAFE_ASYNC_ZBUS
+#include <zephyr/zbus/zbus.h>
+
+/** @brief Message published on @c stsafe_async_chan on every completion. */
+struct stsafe_async_event {
+	const struct device *dev;
+	/**
+	 * Completed descriptor, to tell operations apart only: it may be freed
+	 * or reused by the time an asynchronous subscriber runs.
+	 */
+	struct stsafe_async_op *op;
+	/** @ref stsafe_async_op.user_data of the operation. */
+	void *user_data;
+	/** @ref stsafe_async_op.result of the operation. */
+	stse_ReturnCode_t result;
+};
+
+ZBUS_CHAN_DECLARE(stsafe_async_chan);
+#endif
+
+/**
+ * @brief Queue an operation on the device's STSAFE worker.
+ *
+ * Returns immediately. The worker acquires the device (locked mode), runs
+ * @p op->fn, releases the device, then reports completion through
+ * @p op->cb, @p op->signal and, if enabled, the zbus channel.
+ *
+ * @retval 0 Operation queued.
+ * @retval -ENODEV Device not initialized.
+ * @retval -EPERM Device already used in simple mode.
+ * @retval -EINVAL No operation function given.
+ * @retval -EAGAIN Queue full (see CONFIG_STSAFE_ASYNC_QUEUE_DEPTH).
+ */
+int stsafe_submit(const struct device *dev, struct stsafe_async_op *op);
+
+#ifdef CONFIG_STSAFE_POOL
+/**
+ * @brief Queue an operation on the least loaded instance of a pool.
+ *
+ * The operation runs on the STSAFE worker of that instance. Operations
+ * submitted back to back therefore run on several instances at once: while
+ * one chip computes, the next command goes to another one, even on the same
+ * bus. An operation failing with a communication error is queued again on
+ * another instance, at most once per instance, before completion is
+ * reported as for stsafe_submit().
+ *
+ * @retval 0 Operation queued.
+ * @retval -EINVAL No operation function given.
+ * @retval -EAGAIN No instance could take the operation.
+ */
+int stsafe_pool_submit(const struct device *pool, struct stsafe_async_op *op);
+#endif
+
+#endif /* CONFIG_STSAFE_ASYNC */
+
 #endif /* ZEPHYR_INCLUDE_DRIVERS_STSAFE_H_ */
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2026, CATIE
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ZEPHYR_INCLUDE_DRIVERS_STSAFE_CAPTURE_H_
+#define ZEPHYR_INCLUDE_DRIVERS_STSAFE_CAPTURE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Capture of the I2C traffic between the driver and the secure element.
+ *
+ * A capture is a file header followed by one record per frame moved on the
+ * bus, all fields little-endian:
+ *
+ *   header: [magic "STCP"][version u16][reserved u16]
+ *   record: [time_us u64][bus_id u8][dir u8][len u16][frame...]
+ *
+ * time_us counts from the start of the capture. Command records hold the
+ * whole frame written; response records hold each successful read, so the
+ * length probe STSELib does before reading a response shows up as a short
+ * response record followed by the full one. Each read the chip NACKed while
+ * computing leaves an empty NACK record: the chip finished after the last
+ * NACK of a command and no later than its first response, whatever the
+ * polling schedule of the driver that recorded it.
+ *
+ * The emulator replays captures with CONFIG_EMUL_STSAFE_REPLAY, and
+ * scripts/stsafe_capture.py extracts them from a console log and prints
+ * their timings.
+ */
+
+#define STSAFE_CAPTURE_MAGIC       0x50435453U /* "STCP" */
+#define STSAFE_CAPTURE_VERSION     2U
+#define STSAFE_CAPTURE_HDR_SIZE    8U
+#define STSAFE_CAPTURE_REC_SIZE    12U
+
+/** Record of a command frame written to the chip. */
+#define STSAFE_CAPTURE_CMD 0U
+/** Record of a response read from the chip. */
+#define STSAFE_CAPTURE_RSP 1U
+/** Empty record of a read the chip NACKed while computing. */
+#define STSAFE_CAPTURE_NACK 2U
+
+#ifdef CONFIG_STSAFE_CAPTURE
+/**
+ * @brief Start a new capture, dropping the previous one.
+ */
+void stsafe_capture_start(void);
+
+/**
+ * @brief Stop recording.
+ *
+ * @return Capture size in bytes.
+ */
+size_t stsafe_capture_stop(void);
+
+/**
+ * @brief Get the capture buffer.
+ *
+ * Only stable once the capture is stopped.
+ *
+ * @param len Filled with the capture size in bytes.
+ * @param truncated If not NULL, set when frames were dropped for lack of room.
+ *
+ * @return Start of the capture.
+ */
+const uint8_t *stsafe_capture_get(size_t *len, bool *truncated);
+#endif /* CONFIG_STSAFE_CAPTURE */
+
+#endif /* ZEPHYR_INCLUDE_DRIVERS_STSAFE_CAPTURE_H_ */
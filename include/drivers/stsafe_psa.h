@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2026, CATIE
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ZEPHYR_INCLUDE_DRIVERS_STSAFE_PSA_H_
+#define ZEPHYR_INCLUDE_DRIVERS_STSAFE_PSA_H_
+
+#include <psa/crypto.h>
+
+/*
+ * PSA Crypto support for the STSAFE-A1xx.
+ *
+ * The driver registers itself with the Mbed TLS secure element interface
+ * (MBEDTLS_PSA_CRYPTO_SE_C) for the STSAFE key location before
+ * psa_crypto_init() runs. Once a key slot is registered with
+ * stsafe_psa_register_key(), psa_sign_hash() on its key ID is dispatched by
+ * the PSA core to the chip. Instances are numbered like the STSELib bus IDs:
+ * STSAFE-A120 instances first, then STSAFE-A110.
+ *
+ * Every call acquires the instance (locked mode) for the duration of the
+ * command, so concurrent PSA users are serialized by the driver.
+ */
+
+/** Vendor key location of the keys held in the STSAFE. */
+#define STSAFE_PSA_LOCATION ((psa_key_location_t)CONFIG_STSAFE_PSA_LOCATION)
+
+/** Lifetime of the registered STSAFE keys. */
+#define STSAFE_PSA_LIFETIME                                                                        \
+	PSA_KEY_LIFETIME_FROM_PERSISTENCE_AND_LOCATION(PSA_KEY_PERSISTENCE_DEFAULT,                \
+						       STSAFE_PSA_LOCATION)
+
+/** PSA key ID of private key slot @p slot of STSAFE instance @p inst. */
+#define STSAFE_PSA_KEY_ID(inst, slot)                                                              \
+	((psa_key_id_t)(CONFIG_STSAFE_PSA_KEY_ID_BASE + ((inst) << 8) + (slot)))
+
+/**
+ * @brief Make a private key slot usable through the PSA API.
+ *
+ * Records the key STSAFE_PSA_KEY_ID(@p inst, @p slot) in the PSA key store as
+ * an ECDSA key pair on the CONFIG_STSAFE_PSA_KEY_BITS NIST P curve. The
+ * record is persistent: calling again for a registered slot succeeds.
+ * psa_destroy_key() removes the record, not the key in the chip.
+ *
+ * @retval PSA_SUCCESS The key ID can be used with psa_sign_hash().
+ * @return Error from mbedtls_psa_register_se_key().
+ */
+psa_status_t stsafe_psa_register_key(uint8_t inst, uint8_t slot);
+
+/**
+ * @brief Verify an ECDSA signature, on the chip when one is free.
+ *
+ * Offloads the verification of a NIST P public key to the first instance
+ * that can be taken without waiting, among those already used through
+ * stsafe_acquire(): instances that are unused or in simple mode are left
+ * alone. When none is free, or the curve is not enabled in STSELib, the
+ * public key is imported as a volatile PSA key and verified in software
+ * instead, so callers never queue behind SE traffic.
+ *
+ * @param attributes Attributes of the public key: type and bits.
+ * @param key Public key in the PSA export format (uncompressed point).
+ *
+ * @retval PSA_SUCCESS Valid signature.
+ * @retval PSA_ERROR_INVALID_SIGNATURE Invalid signature.
+ * @return Other PSA error codes.
+ */
+psa_status_t stsafe_psa_verify_hash(const psa_key_attributes_t *attributes, const uint8_t *key,
+				    size_t key_length, psa_algorithm_t alg, const uint8_t *hash,
+				    size_t hash_length, const uint8_t *signature,
+				    size_t signature_length);
+
+#endif /* ZEPHYR_INCLUDE_DRIVERS_STSAFE_PSA_H_ */
@@ -0,0 +1,383 @@
+/*
+ * Copyright (c) 2026, CATIE
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * STSAFE-A1xx driver benchmark.
+ *
+ * Runs a fixed set of STSELib commands in a loop through the locked API
+ * (stsafe_acquire / stsafe_release) and reports throughput and latency for
+ * each of them. On native_sim the secure element is the I2C emulator, so the
+ * figures reflect the driver, the platform layer and the emulated command
+ * execution times, and can be compared from one build to the next.
+ *
+ * A CRC16 microbenchmark runs first: it times the platform CRC over full
+ * size frames, which is what the STSE_CRC16_* implementation choice affects.
+ *
+ * With pool.overlay and CONFIG_STSAFE_ASYNC, a last case queues random
+ * commands on a pool of two chips sharing the bus, whose executions overlap.
+ *
+ * On the emulator, a last case checks that a command slower than the backed
+ * off polls still completes within the budget of the fixed polling schedule.
+ *
+ * With CONFIG_STSAFE_CAPTURE, the command cases are recorded and printed at
+ * the end, so that a run on hardware can be replayed on native_sim with
+ * CONFIG_EMUL_STSAFE_REPLAY. The replay is armed right before the same
+ * cases, so that the bring-up traffic is answered by the model and never
+ * matched against the capture.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/logging/log.h>
+#include <string.h>
+
+#include <drivers/stsafe.h>
+#include <drivers/stsafe_capture.h>
+#ifdef CONFIG_EMUL_STSAFE
+#include <drivers/emul_stsafe.h>
+#endif
+
+LOG_MODULE_REGISTER(main, LOG_LEVEL_INF);
+
+#define ITERATIONS      50
+#define MAX_SIZE        256
+#define ACQUIRE_TIMEOUT K_MSEC(1000)
+#define CRC_FRAME_SIZE  752
+#define CRC_ITERATIONS  2000
+
+static const struct device *const se = DEVICE_DT_GET(DT_NODELABEL(stsafe_1_20));
+#ifdef CONFIG_EMUL_STSAFE
+static const struct emul *const se_emul = EMUL_DT_GET(DT_NODELABEL(stsafe_1_20));
+#endif
+
+static uint8_t tx[MAX_SIZE];
+static uint8_t rx[MAX_SIZE];
+static uint8_t crc_frame[CRC_FRAME_SIZE];
+
+typedef stse_ReturnCode_t (*bench_op_t)(stse_Handle_t *handle, uint16_t size);
+
+static stse_ReturnCode_t op_echo(stse_Handle_t *handle, uint16_t size)
+{
+	stse_ReturnCode_t ret = stse_device_echo(handle, tx, rx, size);
+
+	if (ret == STSE_OK && memcmp(tx, rx, size) != 0) {
+		return STSE_COMMUNICATION_ERROR;
+	}
+	return ret;
+}
+
+static stse_ReturnCode_t op_random(stse_Handle_t *handle, uint16_t size)
+{
+	return stse_generate_random(handle, rx, size);
+}
+
+static stse_ReturnCode_t op_read(stse_Handle_t *handle, uint16_t size)
+{
+	return stse_data_storage_read_data_zone(handle, 0, 0, rx, size, size, STSE_NO_PROT);
+}
+
+struct bench_case {
+	const char *name;
+	bench_op_t op;
+	uint16_t size;
+};
+
+static const struct bench_case cases[] = {
+	{"echo", op_echo, 8},
+	{"echo", op_echo, 128},
+	{"random", op_random, 32},
+	{"read", op_read, 64},
+	{"read", op_read, 256},
+};
+
+static int run_case(const struct bench_case *c)
+{
+	uint32_t min_us = UINT32_MAX;
+	uint32_t max_us = 0;
+	uint64_t total_us = 0;
+	int errors = 0;
+
+	for (int i = 0; i < ITERATIONS; i++) {
+		uint32_t start = k_cycle_get_32();
+
+		stse_Handle_t *stse_handle = stsafe_acquire(se, ACQUIRE_TIMEOUT);
+		if (!stse_handle) {
+			errors++;
+			continue;
+		}
+
+		stse_ReturnCode_t ret = c->op(stse_handle, c->size);
+
+		stsafe_release(se);
+
+		uint32_t us = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+
+		if (ret != STSE_OK) {
+			LOG_ERR("%s %u B: iter %d failed (0x%x)", c->name, c->size, i, ret);
+			errors++;
+			continue;
+		}
+
+		min_us = MIN(min_us, us);
+		max_us = MAX(max_us, us);
+		total_us += us;
+	}
+
+	int ok = ITERATIONS - errors;
+
+	if (ok > 0) {
+		LOG_INF("%-6s %3u B: %4u ops/s, avg %6u us, min %6u us, max %6u us, %d error(s)",
+			c->name, c->size, (uint32_t)(ok * 1000000ULL / MAX(total_us, 1)),
+			(uint32_t)(total_us / ok), min_us, max_us, errors);
+	} else {
+		LOG_ERR("%-6s %3u B: all iterations failed", c->name, c->size);
+	}
+	return errors;
+}
+
+/* The read 64 B case again, batched TXN_OPS to a stsafe_transact() call */
+#define TXN_OPS 8
+
+static stse_ReturnCode_t txn_read(stse_Handle_t *handle, void *user_data)
+{
+	return op_read(handle, 64);
+}
+
+static int run_txn(void)
+{
+	struct stsafe_txn_op ops[TXN_OPS];
+	uint64_t total_us = 0;
+	int errors = 0;
+
+	for (int i = 0; i < ITERATIONS; i++) {
+		for (int j = 0; j < TXN_OPS; j++) {
+			ops[j] = (struct stsafe_txn_op){.fn = txn_read};
+		}
+
+		uint32_t start = k_cycle_get_32();
+		int ran = stsafe_transact(se, ops, TXN_OPS, STSAFE_TXN_STOP_ON_ERROR,
+					  ACQUIRE_TIMEOUT);
+
+		total_us += k_cyc_to_us_floor32(k_cycle_get_32() - start);
+		if (ran != TXN_OPS || ops[TXN_OPS - 1].result != STSE_OK) {
+			LOG_ERR("txn: iter %d failed (%d)", i, ran);
+			errors++;
+		}
+	}
+
+	LOG_INF("txn    %3u B: %4u ops/s, avg %6u us per op, %d batches of %d, %d error(s)", 64,
+		(uint32_t)(ITERATIONS * TXN_OPS * 1000000ULL / MAX(total_us, 1)),
+		(uint32_t)(total_us / (ITERATIONS * TXN_OPS)), ITERATIONS, TXN_OPS, errors);
+	return errors;
+}
+
+static void run_crc(void)
+{
+	uint32_t start = k_cycle_get_32();
+	uint16_t crc = 0;
+
+	for (int i = 0; i < CRC_ITERATIONS; i++) {
+		crc_frame[0] = (uint8_t)i;
+		crc ^= stse_platform_Crc16_Calculate(crc_frame, sizeof(crc_frame));
+	}
+
+	uint64_t ns = k_cyc_to_ns_floor64(k_cycle_get_32() - start);
+
+	LOG_INF("crc16  %3u B: %6u ns/frame, %u KiB/s (0x%04x)", CRC_FRAME_SIZE,
+		(uint32_t)(ns / CRC_ITERATIONS),
+		(uint32_t)((uint64_t)CRC_FRAME_SIZE * CRC_ITERATIONS * 1000000000ULL /
+			   MAX(ns, 1) / 1024),
+		crc);
+}
+
+#if defined(CONFIG_STSAFE_ASYNC) && DT_NODE_EXISTS(DT_NODELABEL(stsafe_pool))
+#define POOL_OPS  64
+#define POOL_SIZE 32
+
+static const struct device *const pool = DEVICE_DT_GET(DT_NODELABEL(stsafe_pool));
+static struct stsafe_async_op pool_ops[POOL_OPS];
+static uint8_t pool_rx[POOL_OPS][POOL_SIZE];
+static K_SEM_DEFINE(pool_done, 0, POOL_OPS);
+static atomic_t pool_errors;
+
+static stse_ReturnCode_t pool_random(stse_Handle_t *handle, void *user_data)
+{
+	return stse_generate_random(handle, user_data, POOL_SIZE);
+}
+
+static void pool_cb(const struct device *dev, struct stsafe_async_op *op)
+{
+	if (op->result != STSE_OK) {
+		atomic_inc(&pool_errors);
+	}
+	k_sem_give(&pool_done);
+}
+
+/* Keep every member's queue fed, so one chip computes while the other talks */
+static int run_pool(void)
+{
+	uint32_t start = k_cycle_get_32();
+	int submitted = 0;
+	int done = 0;
+
+	while (done < POOL_OPS) {
+		if (submitted < POOL_OPS) {
+			struct stsafe_async_op *op = &pool_ops[submitted];
+
+			*op = (struct stsafe_async_op){
+				.fn = pool_random,
+				.user_data = pool_rx[submitted],
+				.cb = pool_cb,
+			};
+			if (stsafe_pool_submit(pool, op) == 0) {
+				submitted++;
+				continue;
+			}
+			if (submitted == done) {
+				LOG_ERR("pool: cannot queue operations");
+				return POOL_OPS - done;
+			}
+		}
+		k_sem_take(&pool_done, K_FOREVER);
+		done++;
+	}
+
+	uint32_t us = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+	int errors = atomic_get(&pool_errors);
+
+	LOG_INF("pool random %u B: %4u ops/s over %d ops, %d error(s)", POOL_SIZE,
+		(uint32_t)(POOL_OPS * 1000000ULL / MAX(us, 1)), POOL_OPS, errors);
+	return errors;
+}
+#endif
+
+#ifdef CONFIG_EMUL_STSAFE
+/* Well past the exponential back-off, well within the fixed schedule's 1 s */
+#define SLOW_EXEC_US 600000
+#define SLOW_SIZE    16
+
+static int run_slow(void)
+{
+	emul_stsafe_set_exec_time(se_emul, EMUL_STSAFE_CMD_UPDATE, SLOW_EXEC_US);
+
+	uint32_t start = k_cycle_get_32();
+	stse_Handle_t *stse_handle = stsafe_acquire(se, ACQUIRE_TIMEOUT);
+
+	if (!stse_handle) {
+		LOG_ERR("slow: cannot acquire the device");
+		return 1;
+	}
+
+	stse_ReturnCode_t ret = stse_data_storage_update_data_zone(
+		stse_handle, 0, 0, tx, SLOW_SIZE, STSE_NON_ATOMIC_ACCESS, STSE_NO_PROT);
+
+	stsafe_release(se);
+
+	if (ret != STSE_OK) {
+		LOG_ERR("slow update (%u us on the chip) failed (0x%x)", SLOW_EXEC_US, ret);
+		return 1;
+	}
+	LOG_INF("slow   update: %u us on the chip, done in %u us", SLOW_EXEC_US,
+		k_cyc_to_us_floor32(k_cycle_get_32() - start));
+	return 0;
+}
+#endif
+
+#ifdef CONFIG_STSAFE_STATS
+/* What the driver saw of the same commands, bus time and polling included */
+static void dump_stats(void)
+{
+	struct stsafe_cmd_stats st;
+
+	for (uint8_t cmd = 0; cmd < STSAFE_STATS_CMDS; cmd++) {
+		if (stsafe_cmd_stats_get(se, cmd, &st) != 0 || st.count == 0) {
+			continue;
+		}
+		LOG_INF("cmd 0x%02x: %5u done, avg %6u us, max %6u us, %u poll(s)", cmd, st.count,
+			(uint32_t)(st.total_us / st.count), st.max_us, st.polls);
+		for (int b = 0; b < STSAFE_STATS_HIST_BUCKETS; b++) {
+			if (st.hist[b] != 0) {
+				LOG_INF("    < %6u us: %u", STSAFE_STATS_HIST_BASE_US << b,
+					st.hist[b]);
+			}
+		}
+	}
+}
+#endif
+
+#ifdef CONFIG_STSAFE_CAPTURE
+/* Read back by scripts/stsafe_capture.py extract */
+static void dump_capture(void)
+{
+	bool truncated;
+	size_t len;
+	const uint8_t *buf;
+
+	stsafe_capture_stop();
+	buf = stsafe_capture_get(&len, &truncated);
+	if (truncated) {
+		LOG_WRN("capture buffer too small, later frames missing");
+	}
+	for (size_t off = 0; off < len; off += 32) {
+		printk("stcap:");
+		for (size_t i = off; i < MIN(off + 32, len); i++) {
+			printk("%02x", buf[i]);
+		}
+		printk("\n");
+	}
+}
+#endif
+
+int main(void)
+{
+	LOG_INF("************************************************************");
+	LOG_INF("   STSAFE-A1xx driver benchmark (%d iterations per case)", ITERATIONS);
+	LOG_INF("************************************************************");
+
+	if (!device_is_ready(se)) {
+		LOG_ERR("STSAFE device not ready");
+		return -ENODEV;
+	}
+
+	for (int i = 0; i < sizeof(tx); i++) {
+		tx[i] = (uint8_t)i;
+	}
+	for (int i = 0; i < sizeof(crc_frame); i++) {
+		crc_frame[i] = (uint8_t)(i * 7);
+	}
+
+	run_crc();
+
+	int errors = 0;
+
+#ifdef CONFIG_EMUL_STSAFE_REPLAY
+	emul_stsafe_replay_arm(se_emul);
+#endif
+#ifdef CONFIG_STSAFE_CAPTURE
+	stsafe_capture_start();
+#endif
+	for (int i = 0; i < ARRAY_SIZE(cases); i++) {
+		errors += run_case(&cases[i]);
+	}
+	errors += run_txn();
+#ifdef CONFIG_STSAFE_CAPTURE
+	dump_capture();
+#endif
+#ifdef CONFIG_EMUL_STSAFE_REPLAY
+	LOG_INF("replay: %u command(s) not matching the capture",
+		emul_stsafe_get_replay_mismatches(se_emul));
+#endif
+#if defined(CONFIG_STSAFE_ASYNC) && DT_NODE_EXISTS(DT_NODELABEL(stsafe_pool))
+	errors += run_pool();
+#endif
+#ifdef CONFIG_EMUL_STSAFE
+	errors += run_slow();
+#endif
+
+#ifdef CONFIG_STSAFE_STATS
+	dump_stats();
+#endif
+
+	LOG_INF("Benchmark complete, errors: %d", errors);
+	return errors == 0 ? 0 : -1;
+}
@@ -85,6 +85,26 @@ static struct k_thread thread_b;
 static struct echo_worker worker_a = {.name = "A", .pattern = 0xAA};
 static struct echo_worker worker_b = {.name = "B", .pattern = 0xBB};
 
+#ifdef CONFIG_STSAFE_LOCK_PROFILE
+static void dump_lock_stats(const struct device *se)
+{
+	struct stsafe_lock_stats st;
+	int ret;
+
+	for (size_t i = 0; (ret = stsafe_lock_stats_get(se, i, &st)) != -ENOENT; i++) {
+		if (ret != 0) {
+			continue;
+		}
+		LOG_INF("%-8s acquires %u timeouts %u wait avg %llu max %u us, "
+			"hold avg %llu max %u us",
+			st.thread != NULL ? k_thread_name_get(st.thread) : "others", st.acquires,
+			st.timeouts, st.acquires ? st.wait_total_us / st.acquires : 0,
+			st.wait_max_us, st.acquires ? st.hold_total_us / st.acquires : 0,
+			st.hold_max_us);
+	}
+}
+#endif
+
 int main(void)
 {
 	LOG_INF("************************************************************");
@@ -110,6 +130,9 @@ int main(void)
 
 	int total_errors = worker_a.errors + worker_b.errors;
 	LOG_INF("All workers finished, total errors: %d", total_errors);
+#ifdef CONFIG_STSAFE_LOCK_PROFILE
+	dump_lock_stats(se);
+#endif
 
 	return total_errors == 0 ? 0 : -1;
 }
@@ -0,0 +1,122 @@
+#!/usr/bin/env python3
+# Copyright (c) 2026 CATIE
+# SPDX-License-Identifier: Apache-2.0
+
+"""Handle STSAFE I2C traffic captures (see include/drivers/stsafe_capture.h).
+
+extract: rebuild the binary capture from the "stcap:" hex lines printed by
+         "stsafe capture dump" or the benchmark sample, in a console log.
+info:    list the exchanges of a capture and summarise the chip time of
+         each command, which is what the emulator replays: up to the last
+         read the chip NACKed if any, else up to the first response.
+"""
+
+import argparse
+import re
+import struct
+import sys
+from collections import defaultdict
+
+MAGIC = 0x50435453
+HDR = struct.Struct("<IHH")
+REC = struct.Struct("<QBBH")
+VERSION = 2
+CMD, RSP, NACK = 0, 1, 2
+DIRS = {CMD: "cmd", RSP: "rsp", NACK: "nack"}
+CMD_MASK = 0x1F
+
+COMMANDS = {
+    0x00: "echo",
+    0x02: "generate_random",
+    0x05: "read",
+    0x06: "update",
+    0x0D: "hibernate",
+    0x14: "query",
+}
+
+
+def extract(args):
+    data = bytearray()
+    for line in args.log:
+        m = re.search(r"stcap:([0-9a-fA-F]+)", line)
+        if m:
+            data += bytes.fromhex(m.group(1))
+    if len(data) < HDR.size or HDR.unpack_from(data)[0] != MAGIC:
+        sys.exit("no capture found in the log")
+    args.output.write(data)
+    print(f"{len(data)} bytes written to {args.output.name}")
+
+
+def records(data):
+    magic, version, _ = HDR.unpack_from(data)
+    if magic != MAGIC:
+        sys.exit("not a capture file")
+    if version != VERSION:
+        sys.exit(f"unsupported capture version {version}")
+    pos = HDR.size
+    while pos + REC.size <= len(data):
+        time_us, bus_id, direction, length = REC.unpack_from(data, pos)
+        pos += REC.size
+        frame = data[pos:pos + length]
+        if len(frame) != length:
+            print("warning: capture ends in the middle of a frame", file=sys.stderr)
+            return
+        pos += length
+        yield time_us, bus_id, direction, frame
+
+
+def info(args):
+    data = args.capture.read()
+    pending = {}
+    chip_us = defaultdict(list)
+    first = last = None
+
+    for time_us, bus_id, direction, frame in records(data):
+        first = time_us if first is None else first
+        last = time_us
+        if args.verbose:
+            print(f"{time_us:12} bus {bus_id} {DIRS.get(direction, '?'):4} {frame.hex()}")
+        if direction == CMD:
+            pending[bus_id] = [time_us, frame[0] if frame else 0, None]
+        elif direction == NACK:
+            if bus_id in pending:
+                pending[bus_id][2] = time_us
+        elif bus_id in pending:
+            # The first response read closes the command; the chip was still
+            # busy at its last NACK, which is the closer bound when there is one
+            sent_us, header, nack_us = pending.pop(bus_id)
+            done_us = nack_us if nack_us is not None else time_us
+            chip_us[header & CMD_MASK].append(done_us - sent_us)
+
+    if first is None:
+        print("empty capture")
+        return
+    print(f"{sum(len(v) for v in chip_us.values())} exchanges over {last - first} us")
+    print(f"{'command':>20} {'count':>6} {'min':>8} {'avg':>8} {'max':>8}  (chip time, us)")
+    for cmd, times in sorted(chip_us.items()):
+        name = COMMANDS.get(cmd, f"0x{cmd:02x}")
+        print(f"{name:>20} {len(times):6} {min(times):8} {sum(times) // len(times):8} "
+              f"{max(times):8}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = parser.add_subparsers(dest="command", required=True)
+
+    p = sub.add_parser("extract", help="rebuild a capture from a console log")
+    p.add_argument("log", type=argparse.FileType("r", errors="replace"))
+    p.add_argument("-o", "--output", type=argparse.FileType("wb"), required=True)
+    p.set_defaults(func=extract)
+
+    p = sub.add_parser("info", help="summarise a capture")
+    p.add_argument("capture", type=argparse.FileType("rb"))
+    p.add_argument("-v", "--verbose", action="store_true", help="list every frame")
+    p.set_defaults(func=info)
+
+    args = parser.parse_args()
+    args.func(args)
+
+
+if __name__ == "__main__":
+    main()